@@ -0,0 +1,52 @@
+// Copyright (c) 2023 Dennis Hezel
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef DEHE_BENCHMARK_FRAMEWORK_HPP
+#define DEHE_BENCHMARK_FRAMEWORK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace benchmark
+{
+inline constexpr std::size_t iterations = 1 << 20;
+inline constexpr int repetitions = 7;
+
+// Prevent the compiler from optimizing away the computation of `value`.
+template <class T>
+void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Run `function` `iterations` times per repetition and report the fastest repetition in nanoseconds per iteration.
+// `function` receives the iteration number so that it can vary the selected alternative.
+template <class Function>
+void run(const char* group, const char* name, Function&& function)
+{
+    double best = 0.0;
+    for (int repetition = 0; repetition < repetitions; ++repetition)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            function(i);
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+        best = repetition == 0 ? nanoseconds : std::min(best, nanoseconds);
+    }
+    std::printf("%-28s %-32s %8.2f ns\n", group, name, best);
+}
+}  // namespace benchmark
+
+#endif  // DEHE_BENCHMARK_FRAMEWORK_HPP
@@ -0,0 +1,100 @@
+# Copyright (c) 2023 Dennis Hezel
+#
+# This software is released under the MIT License.
+# https://opensource.org/licenses/MIT
+
+# Compiles every generated translation unit with -ftime-report (GCC) or -ftime-trace (Clang) and summarizes
+# instantiation time and memory per configuration in ${VARIATE_OUTPUT_DIR}/compile-time-report.csv.
+
+cmake_minimum_required(VERSION 3.19)
+
+set(_variate_report "configuration,total seconds,template instantiation seconds,memory kB\n")
+
+message(STATUS "configuration                   total [s]   instantiation [s]   memory [kB]")
+
+foreach(_variate_source IN LISTS VARIATE_SOURCES)
+    get_filename_component(_variate_name "${_variate_source}" NAME_WE)
+    set(_variate_object "${VARIATE_OUTPUT_DIR}/${_variate_name}.o")
+
+    if(VARIATE_COMPILER_ID STREQUAL "GNU")
+        set(_variate_report_flag "-ftime-report")
+    else()
+        set(_variate_report_flag "-ftime-trace")
+    endif()
+
+    execute_process(
+        COMMAND "${VARIATE_COMPILER}" ${VARIATE_FLAGS} -std=c++20 "-I${VARIATE_INCLUDE_DIR}" ${_variate_report_flag} -c
+                "${_variate_source}" -o "${_variate_object}"
+        RESULT_VARIABLE _variate_result
+        OUTPUT_VARIABLE _variate_output
+        ERROR_VARIABLE _variate_output)
+    if(NOT _variate_result EQUAL 0)
+        message(FATAL_ERROR "Failed to compile ${_variate_source}:\n${_variate_output}")
+    endif()
+
+    set(_variate_total "n/a")
+    set(_variate_instantiation "n/a")
+    set(_variate_memory "n/a")
+    if(VARIATE_COMPILER_ID STREQUAL "GNU")
+        # Time variable   usr   sys   wall   GGC
+        if(_variate_output MATCHES "\n *TOTAL *: *[0-9.]+ +[0-9.]+ +([0-9.]+) +([0-9]+)([kMG])")
+            set(_variate_total "${CMAKE_MATCH_1}")
+            set(_variate_memory "${CMAKE_MATCH_2}")
+            if(CMAKE_MATCH_3 STREQUAL "M")
+                math(EXPR _variate_memory "${_variate_memory} * 1024")
+            elseif(CMAKE_MATCH_3 STREQUAL "G")
+                math(EXPR _variate_memory "${_variate_memory} * 1024 * 1024")
+            endif()
+        endif()
+        if(_variate_output MATCHES "\n *template instantiation *: *[0-9.]+ *\\( *[0-9]+%\\) +[0-9.]+ *\\( *[0-9]+%\\) +([0-9.]+)")
+            set(_variate_instantiation "${CMAKE_MATCH_1}")
+        endif()
+    else()
+        # Clang writes the trace next to the object file. Durations are in microseconds and the totals are summarized at
+        # the end of the trace.
+        file(READ "${VARIATE_OUTPUT_DIR}/${_variate_name}.json" _variate_trace)
+        string(JSON _variate_event_count LENGTH "${_variate_trace}" traceEvents)
+        set(_variate_instantiation_us 0)
+        set(_variate_index "${_variate_event_count}")
+        while(_variate_index GREATER 0)
+            math(EXPR _variate_index "${_variate_index} - 1")
+            string(JSON _variate_event_name GET "${_variate_trace}" traceEvents ${_variate_index} name)
+            if(NOT _variate_event_name MATCHES "^Total ")
+                break()
+            endif()
+            string(JSON _variate_duration GET "${_variate_trace}" traceEvents ${_variate_index} dur)
+            if(_variate_event_name STREQUAL "Total ExecuteCompiler")
+                math(EXPR _variate_total_ms "${_variate_duration} / 1000")
+            elseif(_variate_event_name MATCHES "^Total Instantiate(Class|Function)$")
+                math(EXPR _variate_instantiation_us "${_variate_instantiation_us} + ${_variate_duration}")
+            endif()
+        endwhile()
+        if(DEFINED _variate_total_ms)
+            math(EXPR _variate_seconds "${_variate_total_ms} / 1000")
+            math(EXPR _variate_milliseconds "${_variate_total_ms} % 1000 + 1000")
+            string(SUBSTRING "${_variate_milliseconds}" 1 3 _variate_milliseconds)
+            set(_variate_total "${_variate_seconds}.${_variate_milliseconds}")
+        endif()
+        math(EXPR _variate_seconds "${_variate_instantiation_us} / 1000000")
+        math(EXPR _variate_milliseconds "${_variate_instantiation_us} / 1000 % 1000 + 1000")
+        string(SUBSTRING "${_variate_milliseconds}" 1 3 _variate_milliseconds)
+        set(_variate_instantiation "${_variate_seconds}.${_variate_milliseconds}")
+        unset(_variate_total_ms)
+    endif()
+
+    string(REGEX REPLACE "^variate_([0-9]+)_paths_([0-9]+)_keys$" "\\1 paths x \\2 keys" _variate_configuration
+                         "${_variate_name}")
+    string(APPEND _variate_report "${_variate_configuration},${_variate_total},${_variate_instantiation},${_variate_memory}\n")
+    string(LENGTH "${_variate_configuration}" _variate_length)
+    math(EXPR _variate_length "32 - ${_variate_length}")
+    string(REPEAT " " ${_variate_length} _variate_padding)
+    message(STATUS "${_variate_configuration}${_variate_padding}${_variate_total}        ${_variate_instantiation}"
+                   "              ${_variate_memory}")
+
+    if(VARIATE_LIMIT GREATER 0 AND _variate_total GREATER VARIATE_LIMIT)
+        message(SEND_ERROR "${_variate_configuration} exceeded the limit of ${VARIATE_LIMIT} seconds")
+    endif()
+endforeach()
+
+file(WRITE "${VARIATE_OUTPUT_DIR}/compile-time-report.csv" "${_variate_report}")
+message(STATUS "Written ${VARIATE_OUTPUT_DIR}/compile-time-report.csv")
@@ -0,0 +1,295 @@
+// Copyright (c) 2023 Dennis Hezel
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include <benchmark/framework.hpp>
+#include <variate/variate.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <variant>
+
+#if defined(__GNUC__)
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define BENCHMARK_NOINLINE __declspec(noinline)
+#else
+#define BENCHMARK_NOINLINE
+#endif
+
+// Return one of two or eight alternatives depending on `selector`. RETURN(I) must produce the I-th alternative.
+#define BENCHMARK_SELECT_2(RETURN) \
+    if (selector == 0)             \
+    {                              \
+        return RETURN(0);          \
+    }                              \
+    return RETURN(1)
+
+#define BENCHMARK_SELECT_8(RETURN) \
+    switch (selector)              \
+    {                              \
+        case 0:                    \
+            return RETURN(0);      \
+        case 1:                    \
+            return RETURN(1);      \
+        case 2:                    \
+            return RETURN(2);      \
+        case 3:                    \
+            return RETURN(3);      \
+        case 4:                    \
+            return RETURN(4);      \
+        case 5:                    \
+            return RETURN(5);      \
+        case 6:                    \
+            return RETURN(6);      \
+        default:                   \
+            return RETURN(7);      \
+    }
+
+namespace benchmark
+{
+// Alternative of Words ints. Every alternative has a distinct type.
+template <std::size_t Index, std::size_t Words>
+struct Payload
+{
+    std::array<int, Words> values{static_cast<int>(Index)};
+
+    int value() const noexcept { return values[0] + values[Words - 1]; }
+};
+
+struct Base
+{
+    virtual ~Base() = default;
+
+    virtual int value() const noexcept = 0;
+};
+
+template <std::size_t Index, std::size_t Words>
+struct Derived final : Base
+{
+    Payload<Index, Words> payload;
+
+    int value() const noexcept override { return payload.value(); }
+};
+
+template <std::size_t Words>
+using Variant2 = std::variant<Payload<0, Words>, Payload<1, Words>>;
+
+template <std::size_t Words>
+using Variant8 = std::variant<Payload<0, Words>, Payload<1, Words>, Payload<2, Words>, Payload<3, Words>,
+                              Payload<4, Words>, Payload<5, Words>, Payload<6, Words>, Payload<7, Words>>;
+
+// The same function written with every kind of return type.
+template <std::size_t Alternatives, std::size_t Words>
+struct Functions;
+
+template <std::size_t Words>
+struct Functions<2, Words>
+{
+    BENCHMARK_NOINLINE static auto variate(std::size_t selector)
+    {
+        static constexpr
+            typename dehe::DependentVariate<Payload<0, Words>>::template Type<sizeof(Payload<0, Words>)>
+                var;
+#define BENCHMARK_RETURN(I) var(Payload<I, Words>{})
+        BENCHMARK_SELECT_2(BENCHMARK_RETURN);
+#undef BENCHMARK_RETURN
+    }
+
+    BENCHMARK_NOINLINE static auto fit(std::size_t selector)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+#define BENCHMARK_RETURN(I) var(Payload<I, Words>{})
+                BENCHMARK_SELECT_2(BENCHMARK_RETURN);
+#undef BENCHMARK_RETURN
+            });
+    }
+
+    BENCHMARK_NOINLINE static Variant2<Words> variant(std::size_t selector)
+    {
+#define BENCHMARK_RETURN(I) Variant2<Words>{Payload<I, Words>{}}
+        BENCHMARK_SELECT_2(BENCHMARK_RETURN);
+#undef BENCHMARK_RETURN
+    }
+
+    BENCHMARK_NOINLINE static std::unique_ptr<Base> virtual_base(std::size_t selector)
+    {
+#define BENCHMARK_RETURN(I) std::make_unique<Derived<I, Words>>()
+        BENCHMARK_SELECT_2(BENCHMARK_RETURN);
+#undef BENCHMARK_RETURN
+    }
+
+    BENCHMARK_NOINLINE static std::function<int()> function(std::size_t selector)
+    {
+#define BENCHMARK_RETURN(I)                    \
+    [payload = Payload<I, Words>{}]() noexcept \
+    {                                          \
+        return payload.value();                \
+    }
+        BENCHMARK_SELECT_2(BENCHMARK_RETURN);
+#undef BENCHMARK_RETURN
+    }
+};
+
+template <std::size_t Words>
+struct Functions<8, Words>
+{
+    BENCHMARK_NOINLINE static auto variate(std::size_t selector)
+    {
+        static constexpr
+            typename dehe::DependentVariate<Payload<0, Words>>::template Type<sizeof(Payload<0, Words>)>
+                var;
+#define BENCHMARK_RETURN(I) var(Payload<I, Words>{})
+        BENCHMARK_SELECT_8(BENCHMARK_RETURN);
+#undef BENCHMARK_RETURN
+    }
+
+    BENCHMARK_NOINLINE static auto fit(std::size_t selector)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+#define BENCHMARK_RETURN(I) var(Payload<I, Words>{})
+                BENCHMARK_SELECT_8(BENCHMARK_RETURN);
+#undef BENCHMARK_RETURN
+            });
+    }
+
+    BENCHMARK_NOINLINE static Variant8<Words> variant(std::size_t selector)
+    {
+#define BENCHMARK_RETURN(I) Variant8<Words>{Payload<I, Words>{}}
+        BENCHMARK_SELECT_8(BENCHMARK_RETURN);
+#undef BENCHMARK_RETURN
+    }
+
+    BENCHMARK_NOINLINE static std::unique_ptr<Base> virtual_base(std::size_t selector)
+    {
+#define BENCHMARK_RETURN(I) std::make_unique<Derived<I, Words>>()
+        BENCHMARK_SELECT_8(BENCHMARK_RETURN);
+#undef BENCHMARK_RETURN
+    }
+
+    BENCHMARK_NOINLINE static std::function<int()> function(std::size_t selector)
+    {
+#define BENCHMARK_RETURN(I)                    \
+    [payload = Payload<I, Words>{}]() noexcept \
+    {                                          \
+        return payload.value();                \
+    }
+        BENCHMARK_SELECT_8(BENCHMARK_RETURN);
+#undef BENCHMARK_RETURN
+    }
+};
+
+// Pseudo-random sequence of selectors so that the branch predictor cannot learn which alternative is returned next.
+inline const std::array<unsigned char, 4096> selectors = []
+{
+    std::array<unsigned char, 4096> result{};
+    unsigned state = 12345;
+    for (auto& selector : result)
+    {
+        state = state * 1103515245u + 12345u;
+        selector = static_cast<unsigned char>(state >> 16);
+    }
+    return result;
+}();
+
+template <std::size_t Alternatives>
+std::size_t select(std::size_t iteration)
+{
+    return selectors[iteration % selectors.size()] % Alternatives;
+}
+
+constexpr auto get_value = [](const auto& alternative)
+{
+    return alternative.value();
+};
+
+template <std::size_t Alternatives, std::size_t Words>
+void run_group()
+{
+    using F = Functions<Alternatives, Words>;
+    char group[64];
+    std::snprintf(group, sizeof(group), "%zu alternatives, %zu bytes", Alternatives, sizeof(Payload<0, Words>));
+
+    // Cost of returning the result only
+    benchmark::run(group, "return dehe::Variate",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(F::variate(select<Alternatives>(i)));
+                   });
+    benchmark::run(group, "return dehe::fit",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(F::fit(select<Alternatives>(i)));
+                   });
+    benchmark::run(group, "return std::variant",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(F::variant(select<Alternatives>(i)));
+                   });
+    benchmark::run(group, "return virtual",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(F::virtual_base(select<Alternatives>(i)));
+                   });
+    benchmark::run(group, "return std::function",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(F::function(select<Alternatives>(i)));
+                   });
+
+    // Cost of returning the result, converting it and dispatching on its alternative
+    benchmark::run(group, "make_variant + std::visit",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(
+                           std::visit(get_value, dehe::make_variant(F::variate(select<Alternatives>(i)))));
+                   });
+    benchmark::run(group, "fit + make_variant + std::visit",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(
+                           std::visit(get_value, dehe::make_variant(F::fit(select<Alternatives>(i)))));
+                   });
+    benchmark::run(group, "dehe::visit",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(dehe::visit(get_value, F::variate(select<Alternatives>(i))));
+                   });
+    benchmark::run(group, "fit + dehe::visit",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(dehe::visit(get_value, F::fit(select<Alternatives>(i))));
+                   });
+    benchmark::run(group, "std::variant + std::visit",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(std::visit(get_value, F::variant(select<Alternatives>(i))));
+                   });
+    benchmark::run(group, "virtual call",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(F::virtual_base(select<Alternatives>(i))->value());
+                   });
+    benchmark::run(group, "std::function call",
+                   [](std::size_t i)
+                   {
+                       benchmark::do_not_optimize(F::function(select<Alternatives>(i))());
+                   });
+}
+}  // namespace benchmark
+
+int main()
+{
+    benchmark::run_group<2, 1>();
+    benchmark::run_group<2, 16>();
+    benchmark::run_group<8, 1>();
+    benchmark::run_group<8, 16>();
+}
@@ -0,0 +1,204 @@
+// Copyright (c) 2023 Dennis Hezel
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+// Branch between two I/O strategies for reading a block of a local file: if the block is in the page cache then it is
+// read synchronously with RWF_NOWAIT, otherwise the read is submitted to io_uring. Measures throughput and latency of
+// the branching pipeline against a pipeline that always submits to io_uring.
+
+#include <unifex/file_concepts.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/io_concepts.hpp>
+#include <unifex/just.hpp>
+#include <unifex/linux/io_uring_context.hpp>
+#include <unifex/scope_guard.hpp>
+#include <unifex/span.hpp>
+#include <unifex/sync_wait.hpp>
+#include <variate/unifex.hpp>
+#include <variate/variate.hpp>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+constexpr std::size_t block_size = 4096;
+constexpr std::size_t block_count = 4096;
+constexpr int repetitions = 5;
+
+using File = decltype(unifex::open_file_read_only(std::declval<unifex::linuxos::io_uring_context::scheduler>(),
+                                                  std::filesystem::path{}));
+
+using Buffer = std::array<std::byte, block_size>;
+
+using ReadSender = decltype(unifex::async_read_some_at(std::declval<File&>(), std::int64_t{},
+                                                       std::declval<unifex::span<std::byte>>()));
+
+// Number of bytes read, as sent by an io_uring read. The page cache path sends the same type so that the
+// dehe::VariantSender has a single value type.
+using Bytes = typename decltype(unifex::sync_wait(std::declval<ReadSender>()))::value_type;
+
+// Either serve the read from the page cache synchronously or submit it to io_uring. Both return paths complete with the
+// number of bytes read.
+auto read_block(File& file, int fd, std::size_t offset, Buffer& buffer, bool try_page_cache)
+{
+    return dehe::fit(
+        [&](auto var)
+        {
+            if (try_page_cache)
+            {
+                iovec vector{buffer.data(), buffer.size()};
+                const ssize_t result = ::preadv2(fd, &vector, 1, static_cast<off_t>(offset), RWF_NOWAIT);
+                if (result == static_cast<ssize_t>(buffer.size()))
+                {
+                    return var(unifex::just(static_cast<Bytes>(result)));
+                }
+            }
+            return var(unifex::async_read_some_at(file, static_cast<std::int64_t>(offset),
+                                                  unifex::span<std::byte>{buffer.data(), buffer.size()}));
+        });
+}
+
+// Drop every other block (in a pseudo-random pattern) from the page cache so that roughly half of the reads must go to
+// the disk. Readahead of the io_uring reads may bring some of them back before they are read.
+void evict(int fd, const std::vector<bool>& evicted)
+{
+    for (std::size_t block = 0; block < block_count; ++block)
+    {
+        if (evicted[block])
+        {
+            ::posix_fadvise(fd, static_cast<off_t>(block * block_size), block_size, POSIX_FADV_DONTNEED);
+        }
+    }
+}
+
+// Read every block in `order` once per repetition and report operations per second and latency percentiles.
+template <class Read>
+bool measure(const char* name, int fd, const std::vector<bool>& evicted, const std::vector<std::size_t>& order,
+             Read&& read)
+{
+    std::vector<double> latencies;
+    latencies.reserve(order.size() * repetitions);
+    double seconds{};
+    for (int repetition = 0; repetition < repetitions; ++repetition)
+    {
+        evict(fd, evicted);
+        const auto begin = std::chrono::steady_clock::now();
+        for (const auto block : order)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const auto bytes = unifex::sync_wait(read(block * block_size));
+            const auto end = std::chrono::steady_clock::now();
+            if (!bytes || static_cast<std::size_t>(*bytes) != block_size)
+            {
+                std::fprintf(stderr, "%s: failed to read block %zu\n", name, block);
+                return false;
+            }
+            latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](double p)
+    {
+        return latencies[static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1))];
+    };
+    std::printf("%-36s %10.0f ops/s   p50 %8.2f us   p90 %8.2f us   p99 %8.2f us   p99.9 %8.2f us\n", name,
+                static_cast<double>(latencies.size()) / seconds, percentile(0.5), percentile(0.9), percentile(0.99),
+                percentile(0.999));
+    return true;
+}
+}  // namespace
+
+int main()
+{
+    const auto path = std::filesystem::temp_directory_path() / "variate-io-uring-example.bin";
+    {
+        std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+        const std::vector<char> block(block_size, 'v');
+        for (std::size_t i = 0; i < block_count; ++i)
+        {
+            stream.write(block.data(), static_cast<std::streamsize>(block.size()));
+        }
+    }
+    auto remove_file = unifex::scope_guard{[&]() noexcept
+                                           {
+                                               std::error_code ec;
+                                               std::filesystem::remove(path, ec);
+                                           }};
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::fprintf(stderr, "Failed to open %s\n", path.c_str());
+        return 1;
+    }
+    auto close_fd = unifex::scope_guard{[&]() noexcept
+                                        {
+                                            ::close(fd);
+                                        }};
+    // Pages must be clean before they can be dropped from the page cache.
+    ::fsync(fd);
+
+    std::minstd_rand random{12345};
+    std::vector<std::size_t> order(block_count);
+    std::iota(order.begin(), order.end(), std::size_t{});
+    std::shuffle(order.begin(), order.end(), random);
+    std::vector<bool> evicted(block_count);
+    std::generate(evicted.begin(), evicted.end(),
+                  [&]
+                  {
+                      return (random() & 1) == 1;
+                  });
+
+    unifex::linuxos::io_uring_context context;
+    unifex::inplace_stop_source stop_source;
+    std::thread thread{[&]
+                       {
+                           context.run(stop_source.get_token());
+                       }};
+    auto stop = unifex::scope_guard{[&]() noexcept
+                                    {
+                                        stop_source.request_stop();
+                                        thread.join();
+                                    }};
+
+    auto file = unifex::open_file_read_only(context.get_scheduler(), path);
+    Buffer buffer;
+
+    const bool ok =
+        measure("single path: io_uring", fd, evicted, order,
+                [&](std::size_t offset)
+                {
+                    return unifex::async_read_some_at(file, static_cast<std::int64_t>(offset),
+                                                      unifex::span<std::byte>{buffer.data(), buffer.size()});
+                }) &&
+        measure("dehe::VariantSender: io_uring only", fd, evicted, order,
+                [&](std::size_t offset)
+                {
+                    return dehe::VariantSender{read_block(file, fd, offset, buffer, false)};
+                }) &&
+        measure("dehe::VariantSender: page cache", fd, evicted, order,
+                [&](std::size_t offset)
+                {
+                    return dehe::VariantSender{read_block(file, fd, offset, buffer, true)};
+                });
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+// Copyright (c) 2023 Dennis Hezel
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+/*
+Optional bridge to libunifex. Wrap the result of a variate function whose return paths are senders into a
+`dehe::VariantSender`:
+
+```c++
+auto code(bool ok)
+{
+    static constexpr dehe::Variate var;
+    if (ok)
+    {
+        return var(unifex::just(5));
+    }
+    return var(unifex::just(42));
+}
+
+auto sender = unifex::let_value(unifex::just(true),
+                                [](bool ok)
+                                {
+                                    return dehe::VariantSender{code(ok)};
+                                });
+```
+
+Unlike `unifex::variant_sender`, the sender is not moved out of the type-erased wrapper first. Upon connect the runtime
+index is dispatched on once and the stored sender is connected in place. Initializing the VariantSender from a prvalue,
+as shown above, does not move the stored sender either, whereas `dehe::make_variant_sender` moves it once.
+*/
+
+#ifndef DEHE_VARIATE_UNIFEX_HPP
+#define DEHE_VARIATE_UNIFEX_HPP
+
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/type_list.hpp>
+#include <variate/variate.hpp>
+
+#include <exception>
+#include <new>
+#include <type_traits>
+
+namespace dehe
+{
+namespace detail
+{
+// Completion signatures of a sender that completes like any of the senders in List.
+template <class List>
+struct SenderListTraits;
+
+template <template <class...> class List, class... T>
+struct SenderListTraits<List<T...>>
+{
+    template <template <class...> class Variant, template <class...> class Tuple>
+    using value_types = typename unifex::concat_type_lists_unique_t<
+        unifex::sender_value_types_t<T, unifex::type_list, Tuple>...>::template apply<Variant>;
+
+    template <template <class...> class Variant>
+    using error_types =
+        typename unifex::concat_type_lists_unique_t<unifex::sender_error_types_t<T, unifex::type_list>...,
+                                                    unifex::type_list<std::exception_ptr>>::template apply<Variant>;
+
+    static constexpr bool sends_done = (unifex::sender_traits<T>::sends_done || ...);
+};
+
+// Operation state of a VariantSender. It holds the operation state of the stored sender that was selected at runtime.
+template <class List, class Receiver>
+class VariantSenderOperation;
+
+template <template <class...> class List, class... T, class Receiver>
+class VariantSenderOperation<List<T...>, Receiver>
+{
+  private:
+    using Operations = detail::TypeList<unifex::connect_result_t<T, Receiver>...>;
+    using Limits = detail::TypeListLimits<Operations>;
+
+  public:
+    template <class ErasedT>
+    VariantSenderOperation(ErasedT& erased, Receiver&& receiver) : index(erased.index)
+    {
+        detail::ErasedDispatch<typename ErasedT::KeyType>::apply(
+            index,
+            [&]<detail::size_t I, class Current>()
+            {
+                ::new (static_cast<void*>(operation)) unifex::connect_result_t<Current, Receiver>(
+                    unifex::connect(static_cast<Current&&>(detail::erased_value<Current, I>(erased)),
+                                    static_cast<Receiver&&>(receiver)));
+            });
+    }
+
+    VariantSenderOperation(VariantSenderOperation&&) = delete;
+
+    VariantSenderOperation& operator=(VariantSenderOperation&&) = delete;
+
+    ~VariantSenderOperation()
+    {
+        detail::Dispatch<Operations>::apply(index,
+                                            [&]<detail::size_t, class Operation>()
+                                            {
+                                                get<Operation>().~Operation();
+                                            });
+    }
+
+    friend void tag_invoke(unifex::tag_t<unifex::start>, VariantSenderOperation& self) noexcept
+    {
+        detail::Dispatch<Operations>::apply(self.index,
+                                            [&]<detail::size_t, class Operation>()
+                                            {
+                                                unifex::start(self.get<Operation>());
+                                            });
+    }
+
+  private:
+    template <class Operation>
+    Operation& get() noexcept
+    {
+        return *std::launder(reinterpret_cast<Operation*>(operation));
+    }
+
+    alignas(Limits::alignment) unsigned char operation[Limits::size];
+    detail::size_t index;
+};
+}  // namespace detail
+
+// Sender that completes like the sender stored in `erased`. All return paths of the variate function that produced
+// `erased` must return senders.
+template <class ErasedT>
+requires detail::is_erased_v<ErasedT>
+struct VariantSender
+{
+    using Types = detail::ErasedTypes<ErasedT>;
+
+    template <template <class...> class Variant, template <class...> class Tuple>
+    using value_types = typename detail::SenderListTraits<Types>::template value_types<Variant, Tuple>;
+
+    template <template <class...> class Variant>
+    using error_types = typename detail::SenderListTraits<Types>::template error_types<Variant>;
+
+    static constexpr bool sends_done = detail::SenderListTraits<Types>::sends_done;
+
+    ErasedT erased;
+
+    template <class Receiver>
+    friend auto tag_invoke(unifex::tag_t<unifex::connect>, VariantSender&& self, Receiver&& receiver)
+    {
+        return detail::VariantSenderOperation<Types, Receiver>{self.erased, static_cast<Receiver&&>(receiver)};
+    }
+};
+
+template <class ErasedT>
+VariantSender(ErasedT) -> VariantSender<ErasedT>;
+
+// Like initializing a VariantSender directly but moves the stored sender once.
+template <class Key, std::size_t Size, std::size_t Alignment, class Index>
+[[nodiscard]] auto make_variant_sender(detail::Erased<Key, Size, Alignment, Index>&& erased)
+{
+    return VariantSender<detail::Erased<Key, Size, Alignment, Index>>{
+        static_cast<detail::Erased<Key, Size, Alignment, Index>&&>(erased)};
+}
+}  // namespace dehe
+
+#endif  // DEHE_VARIATE_UNIFEX_HPP
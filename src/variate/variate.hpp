@@ -26,6 +26,30 @@ void use()
 ```
 
 
+To only inspect the result, visit the value in place instead of converting it into a variant first:
+
+```c++
+dehe::visit([](auto&& value) { print(value); }, func(true));
+```
+
+
+If every return path returns an awaitable, the result can be awaited directly. The runtime index is dispatched on once
+and the selected awaitable is awaited in place:
+
+```c++
+int result = co_await func(true);
+```
+
+
+Alternatives can also be constructed in place, which supports types that are neither copyable nor movable:
+
+```c++
+return var.emplace<std::lock_guard<std::mutex>>(mutex);
+// or
+return var(std::in_place_type<std::lock_guard<std::mutex>>, mutex);
+```
+
+
 If a get a contraint error due to sizeof or alignof in var() then specify a sufficiently large size during instantation
 of variate:
 
@@ -34,6 +58,49 @@ of variate:
 ```
 
 
+The index of the return path is stored as `std::size_t` by default. A smaller index type reduces the size of the result
+but limits the number of return paths:
+
+```c++
+    static constexpr dehe::Variate<16, 8, std::uint8_t> var;  // at most 256 return paths
+```
+
+
+Alternatively, let `dehe::fit` size and align the storage to the largest alternative. It invokes the provided generic
+lambda with a suitable Variate:
+
+```c++
+auto func(bool ok)
+{
+    return dehe::fit([&](auto var)
+    {
+        if (ok)
+        {
+            return var(1.5f);
+        }
+        return var("example");
+    });
+}
+```
+
+If all alternatives are trivially copyable, such a function can also be evaluated at compile time:
+
+```c++
+constexpr auto table = std::array{dehe::make_variant(func(true)), dehe::make_variant(func(false))};
+```
+
+If all alternatives are empty, like tag types or captureless lambdas, the result consists of nothing but the index.
+
+
+Alternatives that do not fit into the storage can also be allocated from a `std::pmr::memory_resource`, while smaller
+ones remain inline:
+
+```c++
+    static constexpr dehe::Variate<16> var;
+    return var(std::allocator_arg, std::pmr::get_default_resource(), std::array<char, 1024>{});
+```
+
+
 In template functions `Variate` must be made dependent on the template parameter:
 
 ```c++
@@ -56,16 +123,116 @@ auto func(T param) {
 ```
 
 
+By default, every return path adds one alternative to the variant, even if its type is already present. Use
+`dehe::UniqueVariate` to map all return paths of the same type onto one alternative:
+
+```c++
+auto func(bool ok)
+{
+    static constexpr dehe::UniqueVariate var;
+    if (ok)
+    {
+        return var("yes");
+    }
+    return var("no");
+}
+
+static_assert(std::is_same_v<decltype(dehe::make_variant(func(true))), std::variant<const char*>>);
+```
+
+
+Mark the return path that is taken most often with `var.likely(...)`. Dispatching on the result, e.g. in
+`dehe::make_variant` or `dehe::visit`, then tests that alternative first and annotates it with `[[likely]]`:
+
+```c++
+if (is_error(input))
+{
+    return var(Error{});
+}
+return var.likely(parse(input));
+```
+
+
+The result of another variate function can be returned with `var.flatten(...)`. Its alternatives are added to the
+alternatives of `var` and the resulting variant is flat rather than containing another variant:
+
+```c++
+return var.flatten(other_func(true));
+```
+
+
+To return one of several existing objects without copying it, return a reference with `var.ref(...)`. The alternative
+becomes a `std::reference_wrapper`:
+
+```c++
+if (auto* cached = cache.find(key))
+{
+    return var.ref(*cached);
+}
+return var(build(key));
+```
+
+
+`std::variant` can become valueless by exception and uses a generic index type. `dehe::make_tagged_union` produces a
+never-empty `dehe::TaggedUnion` instead, which uses the smallest possible index type and is trivially copyable if all
+alternatives are:
+
+```c++
+auto result = dehe::make_tagged_union(func(true));
+dehe::visit([](auto&& value) { print(value); }, result);
+```
+
+
+To repeatedly store results into the same variant, assign them in place. The current alternative is move assigned if
+it stays the same and replaced otherwise:
+
+```c++
+std::variant<float, const char*> variant;
+dehe::assign(variant, func(true));
+```
+
+
+If one return path produces the result and all others produce errors, mark it with `var.expected(...)` and use
+`dehe::make_expected` to obtain a `dehe::Expected<T, std::variant<E...>>`:
+
+```c++
+auto result = dehe::make_expected(func(true));
+if (result)
+{
+    print(*result);
+}
+```
+
+
+If all alternatives are callables of the same signature, `dehe::make_invoker` dispatches on the alternative once and
+returns a callable that invokes it through a single function pointer:
+
+```c++
+auto invoker = dehe::make_invoker<int(int)>(func(true));
+invoker(42);
+```
+
+
+Define `DEHE_VARIATE_INSTRUMENT_RETURN_PATHS` in every translation unit to count how often each return path is taken.
+`dehe::for_each_return_path` and `dehe::print_return_paths` report the counts, including return paths that were never
+taken:
+
+```c++
+std::atexit([] { dehe::print_return_paths(); });
+```
+
+
 Implementation details:
 
 * Create a unique type during instantiation of `constexpr dehe::Variate var` by using a lambda.
 * For each call to `var(T v)`
-    * add T to a global typelist map using the unique type as key.
-    * instantiate a friend function that appends T to the typelist stored at key.
+    * find the current size of the typelist stored at key in a global typelist map using the unique type as key.
+      Exponential and binary search over the indices keep the number of instantiations logarithmic.
+    * instantiate a friend function that associates T with the next index of the typelist stored at key.
     * store v and its index in the type-erased wrapper returned from `var(T v)`.
 * Move the type-erased wrapper returned from `var(T v)` into `make_variant()`.
 * Iterate over the types in the global typelist map and compare their index to the runtime index stored in the
-type-erased wrapper.
+type-erased wrapper. For more than a few types, look up the runtime index in a table of function pointers instead.
 * Upon match, move the value stored in the type-erased wrapper to the final variant.
 */
 
@@ -73,11 +240,37 @@ type-erased wrapper.
 #define DEHE_VARIATE_VARIATE_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <new>
 #include <type_traits>
+#include <utility>
 #include <variant>
 
+#ifdef __cpp_impl_coroutine
+#include <coroutine>
+#endif
+
+#ifdef DEHE_VARIATE_INSTRUMENT_RETURN_PATHS
+#include <atomic>
+#include <cstdio>
+#include <version>
+#ifdef __cpp_lib_source_location
+#include <source_location>
+#endif
+#endif
+
 namespace dehe
 {
+template <class... T>
+class TaggedUnion;
+
+template <class T, class E>
+class Expected;
+
 namespace detail
 {
 // Variant index type
@@ -88,19 +281,6 @@ struct TypeList
 {
 };
 
-// Append T to a type list.
-template <class List, class T>
-struct AppendTypeToList;
-
-template <template <class...> class List, class T, class... U>
-struct AppendTypeToList<List<U...>, T>
-{
-    using Type = List<U..., T>;
-};
-
-template <class List, class T>
-using AppendTypeToListT = typename AppendTypeToList<List, T>::Type;
-
 // Conceptually this acts as a global type map from Key to TypeList<Types...>
 template <class Key, detail::size_t Index>
 struct TypeListMap
@@ -111,7 +291,7 @@ struct TypeListMap
 #endif
 
     // Implementation is provided through friend injection performed by TypeListMapAppender.
-    friend constexpr auto get_types_up_to_index(const TypeListMap&);
+    friend constexpr auto get_type_at_index(const TypeListMap&);
 
 #if defined(__GNUC__) && !defined(__clang__)
 #pragma GCC diagnostic pop
@@ -119,7 +299,7 @@ struct TypeListMap
 };
 
 template <class Key, detail::size_t Index>
-using TypesUpToIndex = decltype(get_types_up_to_index(TypeListMap<Key, Index>{}));
+using TypeAtIndex = typename decltype(get_type_at_index(TypeListMap<Key, Index>{}))::type;
 
 // Instantiating this type will append T to the TypeList<Types...> at Key in TypeListMap if Index is equal to
 // sizeof...(Types), otherwise it will fail to compile.
@@ -128,86 +308,346 @@ struct TypeListMapAppender
 {
     static constexpr detail::size_t index = Index;
 
-    // Returns TypeList<Types[0], ..., Types[Index]>.
-    friend constexpr auto get_types_up_to_index(const TypeListMap<Key, Index>&)
+    // Returns std::type_identity<Types[Index]>.
+    friend constexpr auto get_type_at_index(const TypeListMap<Key, Index>&) { return std::type_identity<T>{}; }
+};
+
+// Whether the TypeList<Types...> at Key in TypeListMap has a type at Index, using int-long overload resolution and
+// sfinae on get_type_at_index. The result changes as types are appended, it must therefore be queried from a context
+// that is instantiated anew for every query.
+template <class Key, detail::size_t Index, class = decltype(get_type_at_index(TypeListMap<Key, Index>{}))>
+constexpr bool type_map_has_index(int)
+{
+    return true;
+}
+
+template <class Key, detail::size_t Index>
+constexpr bool type_map_has_index(long)
+{
+    return false;
+}
+
+// Binary search for the size of the TypeList<Types...> at Key in TypeListMap, knowing that it lies within [Low, High].
+// Tag must be unique for every query.
+template <class Key, class Tag, detail::size_t Low, detail::size_t High>
+constexpr detail::size_t type_map_size_between()
+{
+    if constexpr (Low == High)
+    {
+        return Low;
+    }
+    else
     {
-        if constexpr (Index > 0)
+        constexpr detail::size_t middle = Low + (High - Low) / 2;
+        if constexpr (detail::type_map_has_index<Key, middle>(int{}))
         {
-            using Previous = TypesUpToIndex<Key, Index - 1>;
-            using NextList = AppendTypeToListT<Previous, T>;
-            return NextList{};
+            return detail::type_map_size_between<Key, Tag, middle + 1, High>();
         }
         else
         {
-            return detail::TypeList<T>{};
+            return detail::type_map_size_between<Key, Tag, Low, middle>();
         }
     }
-};
+}
 
-template <class Key, detail::size_t Index>
-concept ValidTypeListMapIndex = requires(const TypeListMap<Key, Index>& v) { get_types_up_to_index(v); };
+// Size of the TypeList<Types...> at Key in TypeListMap. Finds an upper bound by probing indices 0, 1, 3, 7, ... and
+// then performs a binary search below it, resulting in a logarithmic number of instantiations. Tag must be unique for
+// every query.
+template <class Key, class Tag, detail::size_t Bound = 1>
+constexpr detail::size_t type_map_size()
+{
+    if constexpr (detail::type_map_has_index<Key, Bound - 1>(int{}))
+    {
+        return detail::type_map_size<Key, Tag, Bound * 2>();
+    }
+    else
+    {
+        return detail::type_map_size_between<Key, Tag, Bound / 2, Bound - 1>();
+    }
+}
 
-// Get TypeList<Types...> for a Key in TypeListMap.
-template <class Key, detail::size_t I = 0, bool = ValidTypeListMapIndex<Key, I + 1>>
-struct GetTypesFromMap : GetTypesFromMap<Key, I + 1>
+// Get TypeList<Types...> for a Key in TypeListMap. The result is memoized per Tag, it must therefore only be used after
+// all types have been appended.
+template <class Key, class Tag = void, class = std::make_index_sequence<detail::type_map_size<Key, Tag>()>>
+struct GetTypesFromMap;
+
+template <class Key, class Tag, detail::size_t... I>
+struct GetTypesFromMap<Key, Tag, std::index_sequence<I...>>
 {
+    using Type = detail::TypeList<TypeAtIndex<Key, I>...>;
 };
 
-template <class Key, detail::size_t I>
-struct GetTypesFromMap<Key, I, false>
+// Instantiate a TypeListMapAppender at the current size of the TypeList at Key in TypeListMap. The default argument
+// creates a unique Tag for every call.
+template <class T, class Key, auto Tag = []() -> void {}>
+constexpr detail::size_t type_map_append()
 {
-    using Type = TypesUpToIndex<Key, I>;
-};
+    return TypeListMapAppender<T, Key, detail::type_map_size<Key, decltype(Tag)>()>{}.index;
+}
 
-// Instantiate a TypeListMapAppender by first recursing to the current size of the TypeList at Key in TypeListMap using
-// int-long overload resolution and sfinae on TypesUpToIndex.
-template <class T, class Key, detail::size_t Index = 0>
-constexpr detail::size_t type_map_append(long)
+template <class Key, detail::size_t Offset, class... T, detail::size_t... I>
+constexpr detail::size_t type_map_append_at(std::index_sequence<I...>)
 {
-    return TypeListMapAppender<T, Key, Index>{}.index;
+    static_cast<void>((TypeListMapAppender<T, Key, Offset + I>{}, ...));
+    return Offset;
 }
 
-template <class T, class Key, detail::size_t Index = 0, class = TypesUpToIndex<Key, Index>>
-constexpr detail::size_t type_map_append(int)
+// Like type_map_append but appends all types of List<T...> as one contiguous block and returns the index of the first.
+template <class Key, auto Tag = []() -> void {}, template <class...> class List, class... T>
+constexpr detail::size_t type_map_append_list(List<T...>*)
 {
-    return detail::type_map_append<T, Key, Index + 1>(int{});
+    return detail::type_map_append_at<Key, detail::type_map_size<Key, decltype(Tag)>(), T...>(
+        std::index_sequence_for<T...>{});
 }
 
-// Type erased return type of a variate function.
-template <class Key, std::size_t Size, std::size_t Alignment>
-struct Erased
+// Index of the first occurrence of T in the TypeList<Types...> at Key in TypeListMap, or sizeof...(I) if there is none.
+template <class T, class Key, detail::size_t... I>
+constexpr detail::size_t type_map_find(std::index_sequence<I...>)
 {
-    detail::size_t index;
-    alignas(Alignment) unsigned char value[Size];
+    detail::size_t index = sizeof...(I);
+    static_cast<void>(((std::is_same_v<T, TypeAtIndex<Key, I>> ? (index = I, true) : false) || ...));
+    return index;
+}
+
+// Like type_map_append but returns the index of T if it has been appended before.
+template <class T, class Key, auto Tag = []() -> void {}>
+constexpr detail::size_t type_map_find_or_append()
+{
+    constexpr detail::size_t size = detail::type_map_size<Key, decltype(Tag)>();
+    constexpr detail::size_t index = detail::type_map_find<T, Key>(std::make_index_sequence<size>{});
+    if constexpr (index == size)
+    {
+        return TypeListMapAppender<T, Key, size>{}.index;
+    }
+    else
+    {
+        return index;
+    }
+}
+
+template <class T, class Key, bool IsUnique, auto Tag = []() -> void {}>
+constexpr detail::size_t type_map_insert()
+{
+    if constexpr (IsUnique)
+    {
+        return detail::type_map_find_or_append<T, Key, Tag>();
+    }
+    else
+    {
+        return detail::type_map_append<T, Key, Tag>();
+    }
+}
+
+// Smallest unsigned integer type that can represent the indices of Size alternatives.
+template <detail::size_t Size>
+using SmallestIndex =
+    std::conditional_t<(Size <= 256), unsigned char, std::conditional_t<(Size <= 65536), unsigned short, detail::size_t>>;
+
+// Recursive union of T... Unlike the bytes of an ErasedStorage it can be constructed and read during constant
+// evaluation.
+template <class... T>
+union RecursiveUnion
+{
+};
+
+template <class First, class... Rest>
+union RecursiveUnion<First, Rest...>
+{
+    First first;
+    RecursiveUnion<Rest...> rest;
+
+    template <class... Args>
+    constexpr explicit RecursiveUnion(std::in_place_index_t<0>, Args&&... args) : first(static_cast<Args&&>(args)...)
+    {
+    }
+
+    template <detail::size_t I, class... Args>
+    requires(I != 0)
+    constexpr explicit RecursiveUnion(std::in_place_index_t<I>, Args&&... args)
+        : rest(std::in_place_index<I - 1>, static_cast<Args&&>(args)...)
+    {
+    }
+
+    template <detail::size_t I, class Self>
+    static constexpr auto& get(Self& self) noexcept
+    {
+        if constexpr (I == 0)
+        {
+            return self.first;
+        }
+        else
+        {
+            return RecursiveUnion<Rest...>::template get<I - 1>(self.rest);
+        }
+    }
+};
+
+// Storage of an Erased whose alternatives are known to be trivially copyable before it is instantiated. Used by
+// `dehe::fit` and allows variate functions to be evaluated at compile time.
+template <class Key, std::size_t Size, std::size_t Alignment, class Index, class List>
+struct UnionErasedStorage;
+
+template <class Key, std::size_t Size, std::size_t Alignment, class Index, template <class...> class List, class... T>
+struct UnionErasedStorage<Key, Size, Alignment, Index, List<T...>>
+{
+    using KeyType = Key;
+
+    static constexpr std::size_t size = Size;
+    static constexpr std::size_t alignment = Alignment;
+
+    detail::RecursiveUnion<T...> value;
+    Index index;
+
+    template <class U, detail::size_t I, class... Args>
+    constexpr explicit UnionErasedStorage(std::in_place_type_t<U>, std::in_place_index_t<I>, Args&&... args)
+        : value(std::in_place_index<I>, static_cast<Args&&>(args)...), index(static_cast<Index>(I))
+    {
+    }
+};
+
+// Storage of an Erased whose alternatives are known to be empty and trivial before it is instantiated. Such alternatives
+// have no state, therefore only the index is stored and every access refers to a default constructed `empty_value`.
+template <class Key, std::size_t Size, std::size_t Alignment, class Index>
+struct IndexErasedStorage
+{
+    using KeyType = Key;
+
+    static constexpr std::size_t size = Size;
+    static constexpr std::size_t alignment = Alignment;
+
+    Index index;
+
+    // The alternative is still constructed to preserve the side effects of its constructor.
+    template <class U, detail::size_t I, class... Args>
+    constexpr explicit IndexErasedStorage(std::in_place_type_t<U>, std::in_place_index_t<I>, Args&&... args)
+        : index(static_cast<Index>(I))
+    {
+        static_cast<void>(U(static_cast<Args&&>(args)...));
+    }
+};
+
+template <class T>
+inline T empty_value{};
+
+template <class T>
+inline constexpr bool is_in_place_type_v = false;
+
+template <class T>
+inline constexpr bool is_in_place_type_v<std::in_place_type_t<T>> = true;
+
+// Alternative that does not fit into the storage of an Erased. It is placed into memory obtained from a memory resource
+// instead.
+template <class T>
+struct Allocated
+{
+    T* pointer;
+    std::pmr::memory_resource* resource;
+
+    template <class... Args>
+    explicit Allocated(std::pmr::memory_resource* memory_resource, Args&&... args)
+        : pointer(static_cast<T*>(memory_resource->allocate(sizeof(T), alignof(T)))), resource(memory_resource)
+    {
+        // Returns the memory to the resource if the constructor of T throws.
+        struct Guard
+        {
+            Allocated& self;
+            bool constructed{};
+
+            ~Guard()
+            {
+                if (!constructed)
+                {
+                    self.resource->deallocate(self.pointer, sizeof(T), alignof(T));
+                }
+            }
+        } guard{*this};
+        ::new (static_cast<void*>(pointer)) T(static_cast<Args&&>(args)...);
+        guard.constructed = true;
+    }
+
+    Allocated(Allocated&& other) noexcept : pointer(other.pointer), resource(other.resource) { other.pointer = nullptr; }
+
+    Allocated& operator=(Allocated&&) = delete;
+
+    ~Allocated()
+    {
+        if (pointer != nullptr)
+        {
+            pointer->~T();
+            resource->deallocate(pointer, sizeof(T), alignof(T));
+        }
+    }
 };
 
-// Turn a list of types into `std::variant` (or any other type produced by `factory`) based on the runtime index and
-// value stored in `erased`.
+template <class T, std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_stored_inline_v = sizeof(T) <= Size && alignof(T) <= Alignment;
+
+// Type that is constructed inside an Erased of the given Size and Alignment to hold an alternative T.
+template <class T, std::size_t Size, std::size_t Alignment>
+using StoredT = std::conditional_t<detail::is_stored_inline_v<T, Size, Alignment>, T, detail::Allocated<T>>;
+
+// Type of the value T stored in an Erased of type ErasedT, taking constness into account.
+template <class T, class ErasedT>
+using ErasedValueT = std::conditional_t<std::is_const_v<ErasedT>, const T, T>;
+
+// The stored value of type T at index I of an Erased.
+template <class T, detail::size_t I, class ErasedT>
+constexpr ErasedValueT<StoredT<T, ErasedT::size, ErasedT::alignment>, ErasedT>& erased_storage(ErasedT& erased)
+{
+    if constexpr (!requires { erased.value; })
+    {
+        return detail::empty_value<T>;
+    }
+    else if constexpr (std::is_union_v<decltype(erased.value)>)
+    {
+        return std::remove_cvref_t<decltype(erased.value)>::template get<I>(erased.value);
+    }
+    else
+    {
+        using Stored = ErasedValueT<StoredT<T, ErasedT::size, ErasedT::alignment>, ErasedT>;
+        return *std::launder(reinterpret_cast<Stored*>(erased.value));
+    }
+}
+
+template <class T, detail::size_t I, class ErasedT>
+constexpr ErasedValueT<T, ErasedT>& erased_value(ErasedT& erased)
+{
+    if constexpr (detail::is_stored_inline_v<T, ErasedT::size, ErasedT::alignment>)
+    {
+        return detail::erased_storage<T, I>(erased);
+    }
+    else
+    {
+        return *detail::erased_storage<T, I>(erased).pointer;
+    }
+}
+
+// Invoke `function.template operator()<Index, T>()` where Index is the runtime `index` and T the type at that index in
+// the list, by comparing the runtime index against every index of the list.
 template <class, class...>
-struct ToVariant;
+struct LinearDispatch;
 
 template <template <class...> class List, class Current, class... Next, class... Previous>
-struct ToVariant<List<Current, Next...>, Previous...>
+struct LinearDispatch<List<Current, Next...>, Previous...>
 {
-    template <class Key, std::size_t Size, std::size_t Alignment, class Factory>
-    static auto apply(Erased<Key, Size, Alignment>& erased, Factory&& factory)
+    template <class Function>
+    static constexpr decltype(auto) apply(detail::size_t index, Function&& function)
     {
-        static constexpr detail::size_t index = sizeof...(Previous);
-        if (index == erased.index)
+        constexpr detail::size_t current_index = sizeof...(Previous);
+        if (current_index == index)
         {
-            return static_cast<Factory&&>(factory).template operator()<index, Previous..., Current, Next...>(
-                static_cast<Current&&>(*reinterpret_cast<Current*>(erased.value)));
+            return static_cast<Function&&>(function).template operator()<current_index, Current>();
         }
-        return ToVariant<List<Next...>, Previous..., Current>::apply(erased, static_cast<Factory&&>(factory));
+        return LinearDispatch<List<Next...>, Previous..., Current>::apply(index, static_cast<Function&&>(function));
     }
 };
 
 template <template <class...> class List, class First, class... Rest>
-struct ToVariant<List<>, First, Rest...>
+struct LinearDispatch<List<>, First, Rest...>
 {
-    template <class Key, std::size_t Size, std::size_t Alignment, class Factory>
-    [[noreturn]] static auto apply(Erased<Key, Size, Alignment>&, Factory&& factory)
-        -> decltype(static_cast<Factory&&>(factory).template operator()<0, First, Rest...>(std::declval<First>()))
+    template <class Function>
+    [[noreturn]] static constexpr auto apply(detail::size_t, Function&& function)
+        -> decltype(static_cast<Function&&>(function).template operator()<0, First>())
     {
 // Possible implementation of C++23 std::unreachable
 #ifdef __GNUC__
@@ -218,60 +658,1334 @@ struct ToVariant<List<>, First, Rest...>
     }
 };
 
-struct StdVariantFactory
+template <class T, class...>
+struct FirstType
 {
-    template <detail::size_t Index, class... T, class Arg>
-    auto operator()(Arg&& arg)
-    {
-        return std::variant<T...>{std::in_place_index<Index>, static_cast<Arg&&>(arg)};
-    }
+    using Type = T;
 };
-}  // namespace detail
 
-template <std::size_t Size = 256, std::size_t Alignment = alignof(double), auto Key = []() -> void {}>
-class Variate
+// Entry of a JumpTable. It is kept outside of the JumpTable so that its template arguments do not contain the list of all
+// alternatives. Otherwise every entry would cost time proportional to the number of alternatives to instantiate, making
+// the table quadratic in the number of alternatives.
+template <detail::size_t Index, class Current, class Function>
+constexpr decltype(auto) invoke_jump_table_entry(Function& function)
 {
-  private:
-    using KeyT = decltype(Key);
+    return static_cast<Function&&>(function).template operator()<Index, Current>();
+}
 
-  public:
-    template <class VariantAlternative,
-              detail::size_t Index = detail::type_map_append<std::decay_t<VariantAlternative>, KeyT>(int{})>
-    requires(sizeof(std::decay_t<VariantAlternative>) <= Size && alignof(std::decay_t<VariantAlternative>) <= Alignment)
-    [[nodiscard]] auto operator()(VariantAlternative&& alternative) const
+// Like LinearDispatch but using a table of function pointers indexed by the runtime index.
+template <class List, class Indices>
+struct JumpTable;
+
+template <template <class...> class List, class... T, detail::size_t... I>
+struct JumpTable<List<T...>, std::index_sequence<I...>>
+{
+    template <class Function>
+    using Invoker = decltype(&detail::invoke_jump_table_entry<0, typename FirstType<T...>::Type, Function>);
+
+    template <class Function>
+    static constexpr Invoker<Function> table[sizeof...(T)] = {&detail::invoke_jump_table_entry<I, T, Function>...};
+
+    template <class Function>
+    static constexpr decltype(auto) apply(detail::size_t index, Function&& function)
     {
-        detail::Erased<KeyT, Size, Alignment> erased;
-        erased.index = Index;
-        using T = std::decay_t<VariantAlternative>;
-        ::new (static_cast<void*>(erased.value)) T(static_cast<VariantAlternative&&>(alternative));
-        return erased;
+        return table<Function>[index](function);
     }
 };
 
-template <class T, auto Key = []() -> void {}>
-struct DependentVariate : Variate<256, alignof(double), Key>
+// Comparing the runtime index against every alternative is cheapest for a few alternatives. Beyond that, dispatch
+// through a table of function pointers to guarantee constant time regardless of the number of alternatives.
+inline constexpr detail::size_t max_linear_dispatch_size = 4;
+
+template <class List>
+struct Dispatch;
+
+template <template <class...> class List, class... T>
+struct Dispatch<List<T...>>
+    : std::conditional_t<(sizeof...(T) <= max_linear_dispatch_size), LinearDispatch<List<T...>>,
+                         JumpTable<List<T...>, std::index_sequence_for<T...>>>
 {
-    template <std::size_t Size = 256, std::size_t Alignment = alignof(double)>
-    using Type = Variate<Size, Alignment, Key>;
 };
 
-// Factory must be a callable type with signature:
-//
-// template <detail::size_t Index, class... T, class Arg>
-// auto operator()(Arg&& arg);
-//
-// Where Index is the index of the runtime value Arg in the types of the resulting variant<T...>.
-template <class Key, std::size_t Size, std::size_t Alignment, class Factory>
-[[nodiscard]] auto make(detail::Erased<Key, Size, Alignment>&& erased, Factory&& factory)
+template <class ErasedT>
+using ErasedTypes = typename detail::GetTypesFromMap<typename std::remove_cvref_t<ErasedT>::KeyType>::Type;
+
+// Key of the TypeList<std::integral_constant<detail::size_t, I>...> holding the indices of all return paths of Key that
+// have been marked with `var.likely(...)`.
+template <class Key>
+struct LikelyKey
 {
-    using Types = typename detail::GetTypesFromMap<Key>::Type;
-    return detail::ToVariant<Types>::apply(erased, static_cast<Factory&&>(factory));
-}
+};
 
-template <class Key, std::size_t Size, std::size_t Alignment>
-[[nodiscard]] auto make_variant(detail::Erased<Key, Size, Alignment>&& erased)
+// Key of the TypeList<std::integral_constant<detail::size_t, I>...> holding the indices of all return paths of Key that
+// have been marked with `var.expected(...)`.
+template <class Key>
+struct ExpectedKey
 {
-    return dehe::make(static_cast<detail::Erased<Key, Size, Alignment>&&>(erased), detail::StdVariantFactory{});
+};
+
+// Like Dispatch over all alternatives of Key, but the indices of return paths marked as likely are tested first, in the
+// order in which they were marked, and annotated with [[likely]]. The remaining alternatives are dispatched on as usual.
+template <class Key, class Likely = typename detail::GetTypesFromMap<LikelyKey<Key>>::Type>
+struct ErasedDispatch : Dispatch<typename detail::GetTypesFromMap<Key>::Type>
+{
+};
+
+template <class Key, class First, class... Rest>
+struct ErasedDispatch<Key, detail::TypeList<First, Rest...>>
+{
+    template <class Function>
+    static constexpr decltype(auto) apply(detail::size_t index, Function&& function)
+    {
+        if (First::value == index) [[likely]]
+        {
+            return static_cast<Function&&>(function).template operator()<First::value, TypeAtIndex<Key, First::value>>();
+        }
+        return ErasedDispatch<Key, detail::TypeList<Rest...>>::apply(index, static_cast<Function&&>(function));
+    }
+};
+
+// Turn the value stored in `erased` into `std::variant` (or any other type produced by `factory`).
+template <class List>
+struct ToVariant;
+
+template <template <class...> class List, class... T>
+struct ToVariant<List<T...>>
+{
+    template <class ErasedT, class Factory>
+    static constexpr decltype(auto) apply(ErasedT& erased, Factory&& factory)
+    {
+        return ErasedDispatch<typename ErasedT::KeyType>::apply(
+            erased.index,
+            [&]<detail::size_t Index, class Current>() -> decltype(auto)
+            {
+                return static_cast<Factory&&>(factory).template operator()<Index, T...>(
+                    static_cast<ErasedValueT<Current, ErasedT>&&>(detail::erased_value<Current, Index>(erased)));
+            });
+    }
+};
+
+struct StdVariantFactory
+{
+    template <detail::size_t Index, class... T, class Arg>
+    constexpr auto operator()(Arg&& arg)
+    {
+        return std::variant<T...>{std::in_place_index<Index>, static_cast<Arg&&>(arg)};
+    }
+};
+
+struct TaggedUnionFactory
+{
+    template <detail::size_t Index, class... T, class Arg>
+    auto operator()(Arg&& arg)
+    {
+        return dehe::TaggedUnion<T...>{std::in_place_index<Index>, static_cast<Arg&&>(arg)};
+    }
+};
+
+// Invoke `visitor` with the value stored in `erased`. The value is passed as an rvalue if the Erased itself was passed as
+// an rvalue.
+template <class Visitor, class ErasedT>
+constexpr decltype(auto) visit(Visitor&& visitor, ErasedT&& erased)
+{
+    return detail::ErasedDispatch<typename std::remove_cvref_t<ErasedT>::KeyType>::apply(
+        erased.index,
+        [&]<detail::size_t Index, class Current>() -> decltype(auto)
+        {
+            using Value = detail::ErasedValueT<Current, std::remove_reference_t<ErasedT>>;
+            if constexpr (std::is_rvalue_reference_v<ErasedT&&>)
+            {
+                return static_cast<Visitor&&>(visitor)(
+                    static_cast<Value&&>(detail::erased_value<Current, Index>(erased)));
+            }
+            else
+            {
+                return static_cast<Visitor&&>(visitor)(detail::erased_value<Current, Index>(erased));
+            }
+        });
+}
+
+// Number of types and largest sizeof and alignof of the types in a list.
+template <class List>
+struct TypeListLimits;
+
+template <template <class...> class List, class... T>
+struct TypeListLimits<List<T...>>
+{
+    static constexpr std::size_t count = sizeof...(T);
+
+    static constexpr std::size_t size = []
+    {
+        std::size_t result{};
+        ((result = sizeof(T) > result ? sizeof(T) : result), ...);
+        return result;
+    }();
+
+    static constexpr std::size_t alignment = []
+    {
+        std::size_t result{};
+        ((result = alignof(T) > result ? alignof(T) : result), ...);
+        return result;
+    }();
+};
+
+// Keys used by `dehe::fit`. The type of the user provided function is unique for every lambda expression and therefore
+// makes for a unique key as well.
+template <class Function, bool IsProbe>
+struct FitKey
+{
+};
+
+// TypeList<Types...> of Key if it is already complete before the first Erased of Key is instantiated, void otherwise.
+template <class Key>
+struct KnownTypes
+{
+    using Type = void;
+};
+
+template <class Function>
+struct KnownTypes<FitKey<Function, false>>
+{
+    using Type = typename detail::GetTypesFromMap<FitKey<Function, true>>::Type;
+};
+
+template <class List>
+inline constexpr bool is_trivially_copyable_list_v = false;
+
+template <template <class...> class List, class... T>
+inline constexpr bool is_trivially_copyable_list_v<List<T...>> = (std::is_trivially_copyable_v<T> && ...);
+
+template <class List>
+inline constexpr bool is_empty_list_v = false;
+
+template <template <class...> class List, class... T>
+inline constexpr bool is_empty_list_v<List<T...>> =
+    ((std::is_empty_v<T> && std::is_trivially_copyable_v<T> && std::is_trivially_default_constructible_v<T>) && ...);
+
+// Whether moving any alternative of List, as stored inside an Erased of the given Size and Alignment, cannot throw.
+template <class List, std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_nothrow_move_constructible_list_v = false;
+
+template <template <class...> class List, class... T, std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_nothrow_move_constructible_list_v<List<T...>, Size, Alignment> =
+    (std::is_nothrow_move_constructible_v<detail::StoredT<T, Size, Alignment>> && ...);
+
+// Whether every alternative of List is stored the same way inside an Erased of InnerSize and InnerAlignment as inside an
+// Erased of Size and Alignment, so that it can be moved from the former into the latter.
+template <class List, std::size_t InnerSize, std::size_t InnerAlignment, std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_flattenable_list_v = false;
+
+template <template <class...> class List, class... T, std::size_t InnerSize, std::size_t InnerAlignment,
+          std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_flattenable_list_v<List<T...>, InnerSize, InnerAlignment, Size, Alignment> =
+    ((std::is_same_v<detail::StoredT<T, InnerSize, InnerAlignment>, detail::StoredT<T, Size, Alignment>> &&
+      sizeof(detail::StoredT<T, Size, Alignment>) <= Size && alignof(detail::StoredT<T, Size, Alignment>) <= Alignment) &&
+     ...);
+
+// Whether every alternative of List, as stored inside an Erased of the given Size and Alignment, is copy constructible,
+// trivially copyable or trivially destructible respectively.
+template <class List, std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_copy_constructible_stored_list_v = false;
+
+template <template <class...> class List, class... T, std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_copy_constructible_stored_list_v<List<T...>, Size, Alignment> =
+    (std::is_copy_constructible_v<detail::StoredT<T, Size, Alignment>> && ...);
+
+template <class List, std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_trivially_copyable_stored_list_v = false;
+
+template <template <class...> class List, class... T, std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_trivially_copyable_stored_list_v<List<T...>, Size, Alignment> =
+    (std::is_trivially_copyable_v<detail::StoredT<T, Size, Alignment>> && ...);
+
+template <class List, std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_trivially_destructible_stored_list_v = false;
+
+template <template <class...> class List, class... T, std::size_t Size, std::size_t Alignment>
+inline constexpr bool is_trivially_destructible_stored_list_v<List<T...>, Size, Alignment> =
+    (std::is_trivially_destructible_v<detail::StoredT<T, Size, Alignment>> && ...);
+
+// Storage of the type erased return type of a variate function. Copies, moves and destroys the stored alternative by
+// dispatching over all alternatives of Key, or by copying bytes if they are all trivial. Function bodies are only
+// instantiated after all types have been appended, but the noexcept-specification of the move constructor might be
+// needed earlier. Moving is therefore only noexcept if the types are known upfront, as is the case for `dehe::fit`. For
+// the same reason the storage is move-only, see CopyableErasedStorage.
+template <class Key, std::size_t Size, std::size_t Alignment, class Index>
+struct ErasedStorage
+{
+    using KeyType = Key;
+
+    static constexpr std::size_t size = Size;
+    static constexpr std::size_t alignment = Alignment;
+
+    alignas(Alignment) unsigned char value[Size];
+    Index index;
+
+    // Constructs T directly inside `value`. Returning the constructed Erased as a prvalue guarantees that the alternative
+    // is never moved on its way to the caller of a variate function.
+    template <class T, detail::size_t I, class... Args>
+    explicit ErasedStorage(std::in_place_type_t<T>, std::in_place_index_t<I>, Args&&... args)
+        : index(static_cast<Index>(I))
+    {
+        ::new (static_cast<void*>(value)) T(static_cast<Args&&>(args)...);
+    }
+
+    ErasedStorage(const ErasedStorage&) = delete;
+
+    ErasedStorage(ErasedStorage&& other) noexcept(
+        detail::is_nothrow_move_constructible_list_v<typename KnownTypes<Key>::Type, Size, Alignment>)
+    {
+        this->construct_from(static_cast<ErasedStorage&&>(other));
+    }
+
+    ErasedStorage& operator=(const ErasedStorage&) = delete;
+
+    // Destroys the current alternative and then move constructs the alternative of `other` in its place.
+    ErasedStorage& operator=(ErasedStorage&& other) noexcept
+    {
+        using Types = typename detail::GetTypesFromMap<Key>::Type;
+        static_assert(detail::is_nothrow_move_constructible_list_v<Types, Size, Alignment>,
+                      "Assigning an Erased requires all alternatives to be nothrow move constructible");
+        if (this != &other)
+        {
+            this->destroy();
+            this->construct_from(static_cast<ErasedStorage&&>(other));
+        }
+        return *this;
+    }
+
+    ~ErasedStorage() { this->destroy(); }
+
+  protected:
+    ErasedStorage() = default;
+
+    void copy_bytes(const ErasedStorage& other) noexcept
+    {
+        std::memcpy(this->value, other.value, Size);
+        this->index = other.index;
+    }
+
+    void construct_from(ErasedStorage&& other)
+    {
+        using Types = typename detail::GetTypesFromMap<Key>::Type;
+        if constexpr (detail::is_trivially_copyable_stored_list_v<Types, Size, Alignment>)
+        {
+            this->copy_bytes(other);
+        }
+        else
+        {
+            this->index = other.index;
+            detail::ErasedDispatch<Key>::apply(other.index,
+                                               [&]<detail::size_t I, class T>()
+                                               {
+                                                   using Stored = detail::StoredT<T, Size, Alignment>;
+                                                   ::new (static_cast<void*>(this->value))
+                                                       Stored(static_cast<Stored&&>(detail::erased_storage<T, I>(other)));
+                                               });
+        }
+    }
+
+    void destroy() noexcept
+    {
+        using Types = typename detail::GetTypesFromMap<Key>::Type;
+        if constexpr (!detail::is_trivially_destructible_stored_list_v<Types, Size, Alignment>)
+        {
+            detail::ErasedDispatch<Key>::apply(this->index,
+                                               [&]<detail::size_t I, class T>()
+                                               {
+                                                   using Stored = detail::StoredT<T, Size, Alignment>;
+                                                   detail::erased_storage<T, I>(*this).~Stored();
+                                               });
+        }
+    }
+};
+
+// ErasedStorage that can also be copied. Only used when all alternatives are known upfront and copy constructible,
+// since a constraint on the copy constructor of ErasedStorage would be checked before all alternatives have been
+// appended.
+template <class Key, std::size_t Size, std::size_t Alignment, class Index>
+struct CopyableErasedStorage : ErasedStorage<Key, Size, Alignment, Index>
+{
+    using ErasedStorage<Key, Size, Alignment, Index>::ErasedStorage;
+
+    CopyableErasedStorage(const CopyableErasedStorage& other) : ErasedStorage<Key, Size, Alignment, Index>()
+    {
+        this->index = other.index;
+        detail::ErasedDispatch<Key>::apply(other.index,
+                                           [&]<detail::size_t I, class T>()
+                                           {
+                                               using Stored = detail::StoredT<T, Size, Alignment>;
+                                               ::new (static_cast<void*>(this->value))
+                                                   Stored(detail::erased_storage<T, I>(other));
+                                           });
+    }
+
+    CopyableErasedStorage(CopyableErasedStorage&&) = default;
+
+    CopyableErasedStorage& operator=(const CopyableErasedStorage& other)
+    {
+        if (this != &other)
+        {
+            CopyableErasedStorage copy{other};
+            *this = static_cast<CopyableErasedStorage&&>(copy);
+        }
+        return *this;
+    }
+
+    CopyableErasedStorage& operator=(CopyableErasedStorage&&) = default;
+
+    ~CopyableErasedStorage() = default;
+};
+
+template <class Key, std::size_t Size, std::size_t Alignment, class Index, class Known = typename KnownTypes<Key>::Type>
+using ErasedBase = std::conditional_t<
+    detail::is_empty_list_v<Known>, IndexErasedStorage<Key, Size, Alignment, Index>,
+    std::conditional_t<
+        detail::is_trivially_copyable_list_v<Known>, UnionErasedStorage<Key, Size, Alignment, Index, Known>,
+        std::conditional_t<detail::is_copy_constructible_stored_list_v<Known, Size, Alignment>,
+                           CopyableErasedStorage<Key, Size, Alignment, Index>,
+                           ErasedStorage<Key, Size, Alignment, Index>>>>;
+
+// Type erased return type of a variate function. It owns the stored alternative and is move-only, unless all
+// alternatives are known upfront. Then it is copyable if they are copy constructible and trivially copyable if they are
+// trivially copyable. If they are also known to be empty then the Erased consists of nothing but the index.
+template <class Key, std::size_t Size, std::size_t Alignment, class Index>
+struct Erased : ErasedBase<Key, Size, Alignment, Index>
+{
+    using ErasedBase<Key, Size, Alignment, Index>::ErasedBase;
+};
+
+template <detail::size_t I, class... T>
+struct NthType;
+
+template <class First, class... Rest>
+struct NthType<0, First, Rest...>
+{
+    using Type = First;
+};
+
+template <detail::size_t I, class First, class... Rest>
+struct NthType<I, First, Rest...> : NthType<I - 1, Rest...>
+{
+};
+
+// Storage of a TaggedUnion. Like ErasedStorage but sized for exactly the alternatives T...
+template <class... T>
+struct TaggedUnionStorage
+{
+    using Limits = detail::TypeListLimits<detail::TypeList<T...>>;
+    using Index = detail::SmallestIndex<sizeof...(T)>;
+
+    alignas(Limits::alignment) unsigned char value[Limits::size];
+    Index tag;
+
+    TaggedUnionStorage() = default;
+
+    // The bytes are zeroed first. Otherwise copying a trivially copyable union, for example into the registers that it is
+    // returned in, reads the bytes that a smaller alternative leaves uninitialized, which GCC warns about.
+    template <detail::size_t I, class... Args>
+    explicit TaggedUnionStorage(std::in_place_index_t<I>, Args&&... args) : value(), tag(static_cast<Index>(I))
+    {
+        ::new (static_cast<void*>(value)) typename detail::NthType<I, T...>::Type(static_cast<Args&&>(args)...);
+    }
+
+    template <class Current, class Self>
+    static auto& value_of(Self& self) noexcept
+    {
+        return *std::launder(reinterpret_cast<ErasedValueT<Current, Self>*>(self.value));
+    }
+};
+
+template <class... T>
+inline constexpr bool is_nothrow_move_constructible_v = (std::is_nothrow_move_constructible_v<T> && ...);
+
+// Copies, moves and destroys the stored alternative by dispatching on the index. Assignment destroys the current
+// alternative and move constructs the new one, which must not throw to keep the union from becoming empty.
+template <class... T>
+struct OwningTaggedUnionStorage : TaggedUnionStorage<T...>
+{
+    using TaggedUnionStorage<T...>::TaggedUnionStorage;
+
+    OwningTaggedUnionStorage(const OwningTaggedUnionStorage& other) requires(std::is_copy_constructible_v<T>&&...)
+        : TaggedUnionStorage<T...>()
+    {
+        this->construct_from(other);
+    }
+
+    OwningTaggedUnionStorage(OwningTaggedUnionStorage&& other) noexcept(detail::is_nothrow_move_constructible_v<T...>)
+        : TaggedUnionStorage<T...>()
+    {
+        this->construct_from(static_cast<OwningTaggedUnionStorage&&>(other));
+    }
+
+    OwningTaggedUnionStorage& operator=(const OwningTaggedUnionStorage& other)
+        requires(std::is_copy_constructible_v<T>&&...)
+    {
+        if (this != &other)
+        {
+            OwningTaggedUnionStorage copy{other};
+            *this = static_cast<OwningTaggedUnionStorage&&>(copy);
+        }
+        return *this;
+    }
+
+    OwningTaggedUnionStorage& operator=(OwningTaggedUnionStorage&& other) noexcept
+    {
+        static_assert(detail::is_nothrow_move_constructible_v<T...>,
+                      "Assigning a TaggedUnion requires all alternatives to be nothrow move constructible");
+        if (this != &other)
+        {
+            this->destroy();
+            this->construct_from(static_cast<OwningTaggedUnionStorage&&>(other));
+        }
+        return *this;
+    }
+
+    ~OwningTaggedUnionStorage() { this->destroy(); }
+
+  private:
+    template <class Other>
+    void construct_from(Other&& other)
+    {
+        this->tag = other.tag;
+        detail::Dispatch<detail::TypeList<T...>>::apply(
+            other.tag,
+            [&]<detail::size_t, class Current>()
+            {
+                using Value = detail::ErasedValueT<Current, std::remove_reference_t<Other>>;
+                ::new (static_cast<void*>(this->value))
+                    Current(static_cast<Value&&>(TaggedUnionStorage<T...>::template value_of<Current>(other)));
+            });
+    }
+
+    void destroy() noexcept
+    {
+        detail::Dispatch<detail::TypeList<T...>>::apply(this->tag,
+                                                        [&]<detail::size_t, class Current>()
+                                                        {
+                                                            TaggedUnionStorage<T...>::template value_of<Current>(*this)
+                                                                .~Current();
+                                                        });
+    }
+};
+
+template <class... T>
+using TaggedUnionBase =
+    std::conditional_t<detail::is_trivially_copyable_list_v<detail::TypeList<T...>>, TaggedUnionStorage<T...>,
+                       OwningTaggedUnionStorage<T...>>;
+
+template <class T>
+inline constexpr bool is_tagged_union_v = false;
+
+template <class... T>
+inline constexpr bool is_tagged_union_v<dehe::TaggedUnion<T...>> = true;
+
+// Like a list of T... but without the type at index Skip, appended to Result<U...>.
+template <detail::size_t Skip, class Result, class... T>
+struct WithoutIndex
+{
+    using Type = Result;
+};
+
+template <detail::size_t Skip, template <class...> class Result, class... U, class First, class... Rest>
+struct WithoutIndex<Skip, Result<U...>, First, Rest...>
+    : WithoutIndex<Skip - 1, std::conditional_t<Skip == 0, Result<U...>, Result<U..., First>>, Rest...>
+{
+};
+
+// Produces an Expected whose value is the alternative at index Value and whose error is a `std::variant` of all other
+// alternatives.
+template <class List>
+struct ExpectedFactory;
+
+template <detail::size_t Value>
+struct ExpectedFactory<detail::TypeList<std::integral_constant<detail::size_t, Value>>>
+{
+    template <detail::size_t Index, class... T, class Arg>
+    auto operator()(Arg&& arg)
+    {
+        using Error = typename detail::WithoutIndex<Value, std::variant<>, T...>::Type;
+        using Result = dehe::Expected<typename detail::NthType<Value, T...>::Type, Error>;
+        if constexpr (Index == Value)
+        {
+            return Result{std::in_place_index<0>, static_cast<Arg&&>(arg)};
+        }
+        else
+        {
+            return Result{std::in_place_index<1>, std::in_place_index<(Index < Value ? Index : Index - 1)>,
+                          static_cast<Arg&&>(arg)};
+        }
+    }
+};
+
+template <class T>
+inline constexpr bool is_erased_v = false;
+
+template <class Key, std::size_t Size, std::size_t Alignment, class Index>
+inline constexpr bool is_erased_v<Erased<Key, Size, Alignment, Index>> = true;
+
+#ifdef __cpp_impl_coroutine
+// Awaiter of `awaitable` as obtained by a plain `co_await awaitable`. Returns a reference to `awaitable` if it is an
+// awaiter itself.
+template <class T>
+decltype(auto) get_awaiter(T&& awaitable)
+{
+    if constexpr (requires { static_cast<T&&>(awaitable).operator co_await(); })
+    {
+        return static_cast<T&&>(awaitable).operator co_await();
+    }
+    else if constexpr (requires { operator co_await(static_cast<T&&>(awaitable)); })
+    {
+        return operator co_await(static_cast<T&&>(awaitable));
+    }
+    else
+    {
+        return static_cast<T&&>(awaitable);
+    }
+}
+
+template <class T>
+using AwaiterT = decltype(detail::get_awaiter(std::declval<T>()));
+
+// Awaiters that are references into the Erased are stored as pointers, all others by value.
+template <class T>
+using StoredAwaiterT = std::conditional_t<std::is_reference_v<AwaiterT<T>>, std::remove_reference_t<AwaiterT<T>>*,
+                                          AwaiterT<T>>;
+
+template <class T>
+StoredAwaiterT<T> make_stored_awaiter(T&& awaitable)
+{
+    if constexpr (std::is_reference_v<AwaiterT<T>>)
+    {
+        auto&& awaiter = detail::get_awaiter(static_cast<T&&>(awaitable));
+        return std::addressof(awaiter);
+    }
+    else
+    {
+        return detail::get_awaiter(static_cast<T&&>(awaitable));
+    }
+}
+
+// Awaits the awaitable stored in an Erased. The runtime index is dispatched on once to obtain the awaiter, which is
+// kept inside the ErasedAwaiter without allocating. Awaitables that are awaiters themselves are awaited in place.
+template <class ErasedT, class List = detail::ErasedTypes<ErasedT>>
+class ErasedAwaiter;
+
+template <class ErasedT, template <class...> class List, class... T>
+class ErasedAwaiter<ErasedT, List<T...>>
+{
+  private:
+    using Awaiters = detail::TypeList<detail::StoredAwaiterT<T>...>;
+    using Limits = detail::TypeListLimits<Awaiters>;
+
+  public:
+    explicit ErasedAwaiter(ErasedT& erased) : index(erased.index)
+    {
+        detail::ErasedDispatch<typename ErasedT::KeyType>::apply(
+            index,
+            [&]<detail::size_t I, class Current>()
+            {
+                ::new (static_cast<void*>(awaiter)) detail::StoredAwaiterT<Current>(
+                    detail::make_stored_awaiter(static_cast<Current&&>(detail::erased_value<Current, I>(erased))));
+            });
+    }
+
+    ErasedAwaiter(ErasedAwaiter&&) = delete;
+
+    ErasedAwaiter& operator=(ErasedAwaiter&&) = delete;
+
+    ~ErasedAwaiter()
+    {
+        dispatch(
+            []<class Stored>(Stored& stored)
+            {
+                stored.~Stored();
+            });
+    }
+
+    bool await_ready()
+    {
+        return dispatch(
+            []<class Stored>(Stored& stored) -> bool
+            {
+                return ErasedAwaiter::get(stored).await_ready();
+            });
+    }
+
+    // The possible return types of the stored awaiter's await_suspend are unified through symmetric transfer.
+    template <class Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle)
+    {
+        return dispatch(
+            [&]<class Stored>(Stored& stored) -> std::coroutine_handle<>
+            {
+                using Result = decltype(ErasedAwaiter::get(stored).await_suspend(handle));
+                if constexpr (std::is_void_v<Result>)
+                {
+                    ErasedAwaiter::get(stored).await_suspend(handle);
+                    return std::noop_coroutine();
+                }
+                else if constexpr (std::is_same_v<bool, Result>)
+                {
+                    if (ErasedAwaiter::get(stored).await_suspend(handle))
+                    {
+                        return std::noop_coroutine();
+                    }
+                    return handle;
+                }
+                else
+                {
+                    return ErasedAwaiter::get(stored).await_suspend(handle);
+                }
+            });
+    }
+
+    // Like `std::visit`, every alternative must produce the same type.
+    decltype(auto) await_resume()
+    {
+        return dispatch(
+            []<class Stored>(Stored& stored) -> decltype(auto)
+            {
+                return ErasedAwaiter::get(stored).await_resume();
+            });
+    }
+
+  private:
+    template <class Stored>
+    static auto& get(Stored& stored) noexcept
+    {
+        if constexpr (std::is_pointer_v<Stored>)
+        {
+            return *stored;
+        }
+        else
+        {
+            return stored;
+        }
+    }
+
+    template <class Function>
+    decltype(auto) dispatch(Function&& function)
+    {
+        return detail::Dispatch<Awaiters>::apply(index,
+                                                 [&]<detail::size_t, class Stored>() -> decltype(auto)
+                                                 {
+                                                     return function(*std::launder(reinterpret_cast<Stored*>(awaiter)));
+                                                 });
+    }
+
+    alignas(Limits::alignment) unsigned char awaiter[Limits::size];
+    detail::size_t index;
+};
+
+// Makes `co_await variate_function()` await the returned alternative.
+template <class Key, std::size_t Size, std::size_t Alignment, class Index>
+auto operator co_await(Erased<Key, Size, Alignment, Index>&& erased)
+{
+    return detail::ErasedAwaiter<Erased<Key, Size, Alignment, Index>>{erased};
+}
+#endif
+
+#if defined(DEHE_VARIATE_INSTRUMENT_RETURN_PATHS) && defined(__cpp_lib_source_location)
+using SourceLocation = std::source_location;
+#else
+// Stand-in for std::source_location that compiles away when return paths are not instrumented. If the standard library
+// does not provide std::source_location then instrumented return paths are counted without their location.
+struct SourceLocation
+{
+    static constexpr SourceLocation current() noexcept { return {}; }
+
+    static constexpr const char* file_name() noexcept { return ""; }
+
+    static constexpr const char* function_name() noexcept { return ""; }
+
+    static constexpr std::uint_least32_t line() noexcept { return 0; }
+};
+#endif
+
+#ifdef DEHE_VARIATE_INSTRUMENT_RETURN_PATHS
+
+// Number of times that a return path has been taken. Counters are constant initialized, so that return paths taken
+// during static initialization are not reset afterwards. They register themselves on first use and during static
+// initialization, so that return paths which are never taken are reported as well. The location is recorded when the
+// path is first taken.
+struct ReturnPathCounter
+{
+    const char* signature;
+    detail::size_t index;
+    std::atomic<std::uint64_t> count{};
+    std::atomic<const char*> file_name{};
+    std::atomic<const char*> function_name{};
+    std::atomic<std::uint_least32_t> line{};
+    std::atomic<bool> registered{};
+    ReturnPathCounter* next{};
+
+    constexpr ReturnPathCounter(const char* return_path_signature, detail::size_t return_path_index) noexcept
+        : signature(return_path_signature), index(return_path_index)
+    {
+    }
+};
+
+inline std::atomic<ReturnPathCounter*> return_path_counters{};
+
+inline bool register_return_path_counter(ReturnPathCounter& counter) noexcept
+{
+    if (!counter.registered.exchange(true))
+    {
+        counter.next = return_path_counters.load();
+        while (!return_path_counters.compare_exchange_weak(counter.next, &counter))
+        {
+        }
+    }
+    return true;
+}
+
+// Names the key and the alternative of a return path.
+template <class Key, class T, detail::size_t I>
+constexpr const char* return_path_signature() noexcept
+{
+#if defined(__clang__) || defined(__GNUC__)
+    return __PRETTY_FUNCTION__;
+#elif defined(_MSC_VER)
+    return __FUNCSIG__;
+#else
+    return "";
+#endif
+}
+
+template <class Key, class T, detail::size_t I>
+constinit inline ReturnPathCounter return_path_counter{detail::return_path_signature<Key, T, I>(), I};
+
+template <class Key, class T, detail::size_t I>
+inline const bool is_return_path_counter_registered =
+    detail::register_return_path_counter(detail::return_path_counter<Key, T, I>);
+
+template <class Key, class T, detail::size_t I>
+void count_return_path(const detail::SourceLocation& location) noexcept
+{
+    // Instantiating the registration reports this return path even if it is never taken
+    static_cast<void>(detail::is_return_path_counter_registered<Key, T, I>);
+    auto& counter = detail::return_path_counter<Key, T, I>;
+    if (counter.count.fetch_add(1, std::memory_order_relaxed) == 0)
+    {
+        // The return path might be taken before its registration has been initialized
+        detail::register_return_path_counter(counter);
+        counter.file_name.store(location.file_name(), std::memory_order_relaxed);
+        counter.function_name.store(location.function_name(), std::memory_order_relaxed);
+        counter.line.store(location.line(), std::memory_order_relaxed);
+    }
+}
+#endif
+
+// Return type of the Variate used during the first pass of `dehe::fit`.
+struct Probe
+{
+};
+
+// Variate used during the first pass of `dehe::fit`. It only records the types of all return paths.
+template <class KeyT>
+struct ProbeVariate
+{
+    template <class VariantAlternative, class T = std::decay_t<VariantAlternative>,
+              class = std::enable_if_t<!detail::is_in_place_type_v<T>>,
+              detail::size_t = detail::type_map_append<T, KeyT>()>
+    detail::Probe operator()(VariantAlternative&&) const
+    {
+        return {};
+    }
+
+    template <class T, class... Args, detail::size_t = detail::type_map_append<T, KeyT>()>
+    detail::Probe operator()(std::in_place_type_t<T>, Args&&...) const
+    {
+        return {};
+    }
+
+    template <class AllocatorArg, class VariantAlternative, class T = std::decay_t<VariantAlternative>,
+              class = std::enable_if_t<std::is_same_v<std::allocator_arg_t, AllocatorArg>>,
+              detail::size_t = detail::type_map_append<T, KeyT>()>
+    detail::Probe operator()(AllocatorArg, std::pmr::memory_resource*, VariantAlternative&&) const
+    {
+        return {};
+    }
+
+    template <class T, class... Args, detail::size_t = detail::type_map_append<T, KeyT>()>
+    detail::Probe emplace(Args&&...) const
+    {
+        return {};
+    }
+
+    template <class VariantAlternative, class T = std::decay_t<VariantAlternative>,
+              class = std::enable_if_t<!detail::is_in_place_type_v<T>>,
+              detail::size_t = detail::type_map_append<T, KeyT>()>
+    detail::Probe likely(VariantAlternative&&) const
+    {
+        return {};
+    }
+
+    template <class VariantAlternative, class T = std::decay_t<VariantAlternative>,
+              class = std::enable_if_t<!detail::is_in_place_type_v<T>>,
+              detail::size_t = detail::type_map_append<T, KeyT>()>
+    detail::Probe expected(VariantAlternative&&) const
+    {
+        return {};
+    }
+
+    template <class T, detail::size_t = detail::type_map_append<std::reference_wrapper<T>, KeyT>()>
+    detail::Probe ref(T&) const
+    {
+        return {};
+    }
+
+    template <class T>
+    void ref(const T&&) const = delete;
+
+    template <class Key, std::size_t Size, std::size_t Alignment, class Index,
+              detail::size_t = detail::type_map_append_list<KeyT>(
+                  static_cast<typename detail::GetTypesFromMap<Key>::Type*>(nullptr))>
+    detail::Probe flatten(detail::Erased<Key, Size, Alignment, Index>&&) const
+    {
+        return {};
+    }
+};
+
+template <std::size_t Size, std::size_t Alignment, class KeyT, bool IsUnique, class Index = detail::size_t>
+class BasicVariate
+{
+  public:
+    // The enable_if ensures that in_place_type arguments are rejected before the alternative is added to the type map.
+    template <class VariantAlternative, class T = std::decay_t<VariantAlternative>,
+              class = std::enable_if_t<!detail::is_in_place_type_v<T>>,
+              detail::size_t I = detail::type_map_insert<T, KeyT, IsUnique>()>
+    requires(sizeof(T) <= Size && alignof(T) <= Alignment)
+    [[nodiscard]] constexpr auto operator()(VariantAlternative&& alternative,
+                                            detail::SourceLocation location = detail::SourceLocation::current()) const
+    {
+        return BasicVariate::make_erased<T, I>(location, static_cast<VariantAlternative&&>(alternative));
+    }
+
+    // Constructs the alternative T from `args` directly inside the returned Erased.
+    template <class T, class... Args, detail::size_t I = detail::type_map_insert<T, KeyT, IsUnique>()>
+    requires(sizeof(T) <= Size && alignof(T) <= Alignment)
+    [[nodiscard]] constexpr auto operator()(std::in_place_type_t<T>, Args&&... args) const
+    {
+        return BasicVariate::make_erased<T, I>(detail::SourceLocation{}, static_cast<Args&&>(args)...);
+    }
+
+    template <class T, class... Args, detail::size_t I = detail::type_map_insert<T, KeyT, IsUnique>()>
+    requires(sizeof(T) <= Size && alignof(T) <= Alignment)
+    [[nodiscard]] constexpr auto emplace(Args&&... args) const
+    {
+        return BasicVariate::make_erased<T, I>(detail::SourceLocation{}, static_cast<Args&&>(args)...);
+    }
+
+    // Like the single argument overload but marks this return path as the hot one. Dispatching on the index of the
+    // resulting Erased tests this alternative first, see ErasedDispatch.
+    template <class VariantAlternative, class T = std::decay_t<VariantAlternative>,
+              class = std::enable_if_t<!detail::is_in_place_type_v<T>>,
+              detail::size_t I = detail::type_map_insert<T, KeyT, IsUnique>(),
+              detail::size_t = detail::type_map_append<std::integral_constant<detail::size_t, I>,
+                                                       detail::LikelyKey<KeyT>>()>
+    requires(sizeof(T) <= Size && alignof(T) <= Alignment)
+    [[nodiscard]] constexpr auto likely(VariantAlternative&& alternative,
+                                        detail::SourceLocation location = detail::SourceLocation::current()) const
+    {
+        return BasicVariate::make_erased<T, I>(location, static_cast<VariantAlternative&&>(alternative));
+    }
+
+    // Like `likely` but additionally designates this return path as the value of `dehe::make_expected`. All other return
+    // paths become its errors.
+    template <class VariantAlternative, class T = std::decay_t<VariantAlternative>,
+              class = std::enable_if_t<!detail::is_in_place_type_v<T>>,
+              detail::size_t I = detail::type_map_insert<T, KeyT, IsUnique>(),
+              detail::size_t = detail::type_map_append<std::integral_constant<detail::size_t, I>,
+                                                       detail::LikelyKey<KeyT>>(),
+              detail::size_t = detail::type_map_append<std::integral_constant<detail::size_t, I>,
+                                                       detail::ExpectedKey<KeyT>>()>
+    requires(sizeof(T) <= Size && alignof(T) <= Alignment)
+    [[nodiscard]] constexpr auto expected(VariantAlternative&& alternative,
+                                          detail::SourceLocation location = detail::SourceLocation::current()) const
+    {
+        return BasicVariate::make_erased<T, I>(location, static_cast<VariantAlternative&&>(alternative));
+    }
+
+    // Returns a reference to `object` instead of a copy. The alternative is a `std::reference_wrapper<T>` and can be
+    // mixed freely with alternatives returned by value. `object` must outlive the returned Erased and everything
+    // produced from it.
+    template <class T, detail::size_t I = detail::type_map_insert<std::reference_wrapper<T>, KeyT, IsUnique>()>
+    requires(sizeof(std::reference_wrapper<T>) <= Size && alignof(std::reference_wrapper<T>) <= Alignment)
+    [[nodiscard]] constexpr auto ref(T& object,
+                                     detail::SourceLocation location = detail::SourceLocation::current()) const
+    {
+        return BasicVariate::make_erased<std::reference_wrapper<T>, I>(location, object);
+    }
+
+    // Like `std::ref`, rejects const rvalues which `T&` would otherwise bind to.
+    template <class T>
+    void ref(const T&&) const = delete;
+
+    // Returns the alternative stored in `inner`, the result of another variate function, as if it had been returned by
+    // this one. All alternatives of `inner` are spliced into the alternatives of this Variate, so that converting the
+    // result produces a single flat variant instead of a variant nested inside a variant. The alternatives are always
+    // appended, even for a UniqueVariate.
+    template <class InnerKey, std::size_t InnerSize, std::size_t InnerAlignment, class InnerIndex,
+              class InnerTypes = typename detail::GetTypesFromMap<InnerKey>::Type,
+              detail::size_t Offset = detail::type_map_append_list<KeyT>(static_cast<InnerTypes*>(nullptr))>
+    requires(detail::is_flattenable_list_v<InnerTypes, InnerSize, InnerAlignment, Size, Alignment>)
+    [[nodiscard]] constexpr auto flatten(detail::Erased<InnerKey, InnerSize, InnerAlignment, InnerIndex>&& inner,
+                                         detail::SourceLocation location = detail::SourceLocation::current()) const
+    {
+        return detail::ErasedDispatch<InnerKey>::apply(
+            inner.index,
+            [&]<detail::size_t I, class T>()
+            {
+                using Stored = detail::StoredT<T, Size, Alignment>;
+                return BasicVariate::make_erased<Stored, Offset + I>(
+                    location, static_cast<Stored&&>(detail::erased_storage<T, I>(inner)));
+            });
+    }
+
+    // Like the single argument overload but an alternative that does not fit into the storage is placed into memory
+    // allocated from `resource` instead. The memory is returned to `resource` when the alternative is destroyed. Like
+    // above, the enable_if rejects calls of the same arity before the alternative is added to the type map.
+    template <class AllocatorArg, class VariantAlternative, class T = std::decay_t<VariantAlternative>,
+              class = std::enable_if_t<std::is_same_v<std::allocator_arg_t, AllocatorArg>>,
+              detail::size_t I = detail::type_map_insert<T, KeyT, IsUnique>()>
+    requires(detail::is_stored_inline_v<T, Size, Alignment> ||
+             (sizeof(detail::Allocated<T>) <= Size && alignof(detail::Allocated<T>) <= Alignment))
+    [[nodiscard]] constexpr auto operator()(AllocatorArg, std::pmr::memory_resource* resource,
+                                            VariantAlternative&& alternative,
+                                            detail::SourceLocation location = detail::SourceLocation::current()) const
+    {
+        if constexpr (detail::is_stored_inline_v<T, Size, Alignment>)
+        {
+            return BasicVariate::make_erased<T, I>(location, static_cast<VariantAlternative&&>(alternative));
+        }
+        else
+        {
+            return BasicVariate::make_erased<detail::Allocated<T>, I>(location, resource,
+                                                                      static_cast<VariantAlternative&&>(alternative));
+        }
+    }
+
+  private:
+    template <class T, detail::size_t I, class... Args>
+    static constexpr auto make_erased([[maybe_unused]] const detail::SourceLocation& location, Args&&... args)
+    {
+        static_assert(I <= static_cast<Index>(-1), "Too many return paths for the index type of this Variate");
+#ifdef DEHE_VARIATE_INSTRUMENT_RETURN_PATHS
+        if (!std::is_constant_evaluated())
+        {
+            detail::count_return_path<KeyT, T, I>(location);
+        }
+#endif
+        return detail::Erased<KeyT, Size, Alignment, Index>{std::in_place_type<T>, std::in_place_index<I>,
+                                                            static_cast<Args&&>(args)...};
+    }
+};
+}  // namespace detail
+
+// Index is the type used to store the index of the return path. A smaller type, like `std::uint8_t`, reduces the size
+// of the result but limits the number of return paths.
+template <std::size_t Size = 256, std::size_t Alignment = alignof(double), class Index = detail::size_t,
+          auto Key = []() -> void {}>
+class Variate : public detail::BasicVariate<Size, Alignment, decltype(Key), false, Index>
+{
+};
+
+// Like Variate but all return paths of the same decayed type share one alternative in the resulting variant.
+template <std::size_t Size = 256, std::size_t Alignment = alignof(double), class Index = detail::size_t,
+          auto Key = []() -> void {}>
+class UniqueVariate : public detail::BasicVariate<Size, Alignment, decltype(Key), true, Index>
+{
+};
+
+template <class T, auto Key = []() -> void {}>
+struct DependentVariate : Variate<256, alignof(double), detail::size_t, Key>
+{
+    template <std::size_t Size = 256, std::size_t Alignment = alignof(double), class Index = detail::size_t>
+    using Type = Variate<Size, Alignment, Index, Key>;
+
+    template <std::size_t Size = 256, std::size_t Alignment = alignof(double), class Index = detail::size_t>
+    using UniqueType = UniqueVariate<Size, Alignment, Index, Key>;
+};
+
+// Never-empty tagged union of T... Unlike `std::variant` it uses the smallest index type that can represent all
+// alternatives and is trivially copyable if all alternatives are. Alternatives must be nothrow move constructible for
+// the union to be assignable.
+template <class... T>
+class TaggedUnion : public detail::TaggedUnionBase<T...>
+{
+  public:
+    using detail::TaggedUnionBase<T...>::TaggedUnionBase;
+
+    TaggedUnion() = delete;
+
+    [[nodiscard]] std::size_t index() const noexcept { return this->tag; }
+
+    template <std::size_t I>
+    [[nodiscard]] auto& get() & noexcept
+    {
+        return TaggedUnion::template value_of<typename detail::NthType<I, T...>::Type>(*this);
+    }
+
+    template <std::size_t I>
+    [[nodiscard]] auto& get() const& noexcept
+    {
+        return TaggedUnion::template value_of<typename detail::NthType<I, T...>::Type>(*this);
+    }
+
+    template <std::size_t I>
+    [[nodiscard]] auto&& get() && noexcept
+    {
+        using Value = typename detail::NthType<I, T...>::Type;
+        return static_cast<Value&&>(TaggedUnion::template value_of<Value>(*this));
+    }
+};
+
+// Either a value of type T or an error of type E, like C++23 `std::expected`. Accessing the value of an Expected that
+// holds an error, or vice versa, is undefined behavior.
+template <class T, class E>
+class Expected : public TaggedUnion<T, E>
+{
+  public:
+    using TaggedUnion<T, E>::TaggedUnion;
+
+    [[nodiscard]] bool has_value() const noexcept { return this->index() == 0; }
+
+    explicit operator bool() const noexcept { return has_value(); }
+
+    [[nodiscard]] T& value() & noexcept { return this->template get<0>(); }
+
+    [[nodiscard]] const T& value() const& noexcept { return this->template get<0>(); }
+
+    [[nodiscard]] T&& value() && noexcept { return static_cast<Expected&&>(*this).template get<0>(); }
+
+    [[nodiscard]] E& error() & noexcept { return this->template get<1>(); }
+
+    [[nodiscard]] const E& error() const& noexcept { return this->template get<1>(); }
+
+    [[nodiscard]] E&& error() && noexcept { return static_cast<Expected&&>(*this).template get<1>(); }
+
+    [[nodiscard]] T& operator*() & noexcept { return value(); }
+
+    [[nodiscard]] const T& operator*() const& noexcept { return value(); }
+
+    [[nodiscard]] T* operator->() noexcept { return &value(); }
+
+    [[nodiscard]] const T* operator->() const noexcept { return &value(); }
+};
+
+// Invoke `function` with a Variate whose storage is sized and aligned to fit exactly the largest alternative returned
+// by `function` and whose index type is the smallest that can represent all alternatives. The function is instantiated
+// twice: once in an unevaluated context to collect the types of all return paths and once more with the appropriately
+// sized Variate.
+template <class Function>
+[[nodiscard]] constexpr auto fit(Function&& function)
+{
+    using ProbeKey = detail::FitKey<std::remove_cvref_t<Function>, true>;
+    using ProbeResult = decltype(static_cast<Function&&>(function)(detail::ProbeVariate<ProbeKey>{}));
+    static_assert(std::is_same_v<detail::Probe, ProbeResult>, "Every return path of `function` must return var(...)");
+    using Limits = detail::TypeListLimits<typename detail::GetTypesFromMap<ProbeKey>::Type>;
+    using Var = detail::BasicVariate<Limits::size, Limits::alignment,
+                                     detail::FitKey<std::remove_cvref_t<Function>, false>, false,
+                                     detail::SmallestIndex<Limits::count>>;
+    return static_cast<Function&&>(function)(Var{});
+}
+
+// Factory must be a callable type with signature:
+//
+// template <detail::size_t Index, class... T, class Arg>
+// auto operator()(Arg&& arg);
+//
+// Where Index is the index of the runtime value Arg in the types of the resulting variant<T...>.
+template <class Key, std::size_t Size, std::size_t Alignment, class Index, class Factory>
+[[nodiscard]] constexpr auto make(detail::Erased<Key, Size, Alignment, Index>&& erased, Factory&& factory)
+{
+    using Types = typename detail::GetTypesFromMap<Key>::Type;
+    return detail::ToVariant<Types>::apply(erased, static_cast<Factory&&>(factory));
+}
+
+template <class Key, std::size_t Size, std::size_t Alignment, class Index>
+[[nodiscard]] constexpr auto make_variant(detail::Erased<Key, Size, Alignment, Index>&& erased)
+{
+    return dehe::make(static_cast<detail::Erased<Key, Size, Alignment, Index>&&>(erased), detail::StdVariantFactory{});
+}
+
+// Moves the alternative stored in `erased` into `variant`, which must be of the type produced by make_variant. If
+// `variant` already holds the same alternative and it is move assignable then it is move assigned, otherwise it is
+// emplaced. Unlike assigning the
+// result of make_variant, this neither constructs a temporary variant nor destroys the current alternative of `variant`
+// when the alternative stays the same.
+template <class... T, class Key, std::size_t Size, std::size_t Alignment, class Index>
+constexpr void assign(std::variant<T...>& variant, detail::Erased<Key, Size, Alignment, Index>&& erased)
+{
+    static_assert(std::is_same_v<detail::TypeList<T...>, typename detail::GetTypesFromMap<Key>::Type>,
+                  "The variant must have the same alternatives as the result of make_variant");
+    detail::ErasedDispatch<Key>::apply(erased.index,
+                                       [&]<detail::size_t I, class Current>()
+                                       {
+                                           auto&& value = detail::erased_value<Current, I>(erased);
+                                           if constexpr (std::is_move_assignable_v<Current>)
+                                           {
+                                               if (variant.index() == I)
+                                               {
+                                                   std::get<I>(variant) = static_cast<Current&&>(value);
+                                                   return;
+                                               }
+                                           }
+                                           variant.template emplace<I>(static_cast<Current&&>(value));
+                                       });
+}
+
+// Like make_variant but produces a TaggedUnion.
+template <class Key, std::size_t Size, std::size_t Alignment, class Index>
+[[nodiscard]] auto make_tagged_union(detail::Erased<Key, Size, Alignment, Index>&& erased)
+{
+    return dehe::make(static_cast<detail::Erased<Key, Size, Alignment, Index>&&>(erased),
+                      detail::TaggedUnionFactory{});
+}
+
+// Like make_variant but produces an Expected. Its value is the alternative returned through `var.expected(...)`, which
+// must be used by exactly one return path, and its error is a `std::variant` of all other alternatives. The value is
+// tested for first.
+template <class Key, std::size_t Size, std::size_t Alignment, class Index>
+[[nodiscard]] auto make_expected(detail::Erased<Key, Size, Alignment, Index>&& erased)
+{
+    using Expected = typename detail::GetTypesFromMap<detail::ExpectedKey<Key>>::Type;
+    static_assert(detail::TypeListLimits<Expected>::count == 1,
+                  "Exactly one return path must return var.expected(...) to use make_expected");
+    return dehe::make(static_cast<detail::Erased<Key, Size, Alignment, Index>&&>(erased),
+                      detail::ExpectedFactory<Expected>{});
+}
+
+// Holds the alternative of an Erased together with a pointer to a function that invokes it. Dispatching on the index
+// happens once upon construction, every call thereafter is a single indirect call. All alternatives must be invocable
+// with Args... and return something convertible to R.
+template <class Signature, class ErasedT>
+class Invoker;
+
+template <class R, class... Args, class ErasedT>
+class Invoker<R(Args...), ErasedT>
+{
+  private:
+    using Function = R (*)(ErasedT&, Args...);
+
+  public:
+    explicit Invoker(ErasedT&& erased)
+        : erased(static_cast<ErasedT&&>(erased)),
+          function(detail::ErasedDispatch<typename ErasedT::KeyType>::apply(this->erased.index,
+                                                                            []<detail::size_t I, class T>() -> Function
+                                                                            {
+                                                                                return &Invoker::invoke<I, T>;
+                                                                            }))
+    {
+    }
+
+    R operator()(Args... args) { return function(erased, static_cast<Args&&>(args)...); }
+
+  private:
+    template <detail::size_t I, class T>
+    static R invoke(ErasedT& erased, Args... args)
+    {
+        if constexpr (std::is_void_v<R>)
+        {
+            detail::erased_value<T, I>(erased)(static_cast<Args&&>(args)...);
+        }
+        else
+        {
+            return detail::erased_value<T, I>(erased)(static_cast<Args&&>(args)...);
+        }
+    }
+
+    ErasedT erased;
+    Function function;
+};
+
+template <class Signature, class Key, std::size_t Size, std::size_t Alignment, class Index>
+[[nodiscard]] auto make_invoker(detail::Erased<Key, Size, Alignment, Index>&& erased)
+{
+    return Invoker<Signature, detail::Erased<Key, Size, Alignment, Index>>{
+        static_cast<detail::Erased<Key, Size, Alignment, Index>&&>(erased)};
+}
+
+// Invoke `visitor` with the alternative stored in `tagged_union`, passed with the value category of `tagged_union`.
+template <class Visitor, class Union>
+requires detail::is_tagged_union_v<std::remove_cvref_t<Union>>
+decltype(auto) visit(Visitor&& visitor, Union&& tagged_union)
+{
+    return detail::Dispatch<std::remove_cvref_t<Union>>::apply(
+        tagged_union.index(),
+        [&]<detail::size_t I, class>() -> decltype(auto)
+        {
+            return static_cast<Visitor&&>(visitor)(static_cast<Union&&>(tagged_union).template get<I>());
+        });
+}
+
+#ifdef DEHE_VARIATE_INSTRUMENT_RETURN_PATHS
+// Snapshot of a return path counter. `file_name`, `function_name` and `line` describe the first `var(...)` call of the
+// return path. They are empty if the path has never been taken or if the alternative was constructed in place.
+struct ReturnPath
+{
+    const char* file_name;
+    const char* function_name;
+    std::uint_least32_t line;
+    const char* signature;
+    std::size_t index;
+    std::uint64_t count;
+};
+
+// Invoke `function` with a ReturnPath for every return path of every Variate in the program.
+template <class Function>
+void for_each_return_path(Function&& function)
+{
+    for (auto* counter = detail::return_path_counters.load(); counter != nullptr; counter = counter->next)
+    {
+        const char* file_name = counter->file_name.load(std::memory_order_relaxed);
+        const char* function_name = counter->function_name.load(std::memory_order_relaxed);
+        function(ReturnPath{file_name != nullptr ? file_name : "", function_name != nullptr ? function_name : "",
+                            counter->line.load(std::memory_order_relaxed), counter->signature, counter->index,
+                            counter->count.load(std::memory_order_relaxed)});
+    }
+}
+
+// Print the number of times that every return path has been taken, for example from a function registered with
+// `std::atexit`.
+inline void print_return_paths(std::FILE* file = stderr)
+{
+    dehe::for_each_return_path(
+        [&](const ReturnPath& path)
+        {
+            std::fprintf(file, "%12llu  %s:%lu  %s  [%zu] %s\n", static_cast<unsigned long long>(path.count),
+                         path.file_name, static_cast<unsigned long>(path.line), path.function_name, path.index,
+                         path.signature);
+        });
+}
+#endif
+
+// Invoke `visitor` with the values stored in `erased...` directly, without converting them into variants first. Like
+// `std::visit`, every combination of alternatives must produce the same return type.
+template <class Visitor, class First, class... Rest>
+requires(detail::is_erased_v<std::remove_cvref_t<First>> && (detail::is_erased_v<std::remove_cvref_t<Rest>> && ...))
+constexpr decltype(auto) visit(Visitor&& visitor, First&& first, Rest&&... rest)
+{
+    if constexpr (sizeof...(Rest) == 0)
+    {
+        return detail::visit(static_cast<Visitor&&>(visitor), static_cast<First&&>(first));
+    }
+    else
+    {
+        return detail::visit(
+            [&]<class Arg>(Arg&& arg) -> decltype(auto)
+            {
+                return dehe::visit(
+                    [&]<class... Args>(Args&&... args) -> decltype(auto)
+                    {
+                        return static_cast<Visitor&&>(visitor)(static_cast<Arg&&>(arg), static_cast<Args&&>(args)...);
+                    },
+                    static_cast<Rest&&>(rest)...);
+            },
+            static_cast<First&&>(first));
+    }
 }
 }  // namespace dehe
 
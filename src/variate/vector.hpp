@@ -0,0 +1,132 @@
+// Copyright (c) 2023 Dennis Hezel
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+/*
+Batch counterpart to `dehe::make_variant`. Collect the results of many calls to a variate function into a
+`dehe::VariateVector`, which keeps every alternative in its own contiguous array:
+
+```c++
+dehe::VariateVector<decltype(func(true))> results;
+for (auto input : inputs)
+{
+    results.push_back(func(input));
+}
+results.for_each_alternative(
+    [](auto values)
+    {
+        for (auto& value : values)
+        {
+            process(value);
+        }
+    });
+```
+*/
+
+#ifndef DEHE_VARIATE_VECTOR_HPP
+#define DEHE_VARIATE_VECTOR_HPP
+
+#include <variate/variate.hpp>
+
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace dehe
+{
+namespace detail
+{
+template <detail::size_t I, class T>
+struct VectorBucket
+{
+    std::vector<T> values;
+};
+
+// One vector per alternative. Alternatives of the same type at different indices are kept apart.
+template <class List, class Indices>
+struct VectorBuckets;
+
+template <template <class...> class List, class... T, detail::size_t... I>
+struct VectorBuckets<List<T...>, std::index_sequence<I...>> : detail::VectorBucket<I, T>...
+{
+    template <class Function>
+    void for_each(Function& function)
+    {
+        (function(std::span<T>{detail::VectorBucket<I, T>::values}), ...);
+    }
+
+    detail::size_t size() const noexcept { return (detail::VectorBucket<I, T>::values.size() + ... + 0); }
+
+    void clear() noexcept { (detail::VectorBucket<I, T>::values.clear(), ...); }
+};
+
+template <detail::size_t I, class T>
+std::vector<T>& bucket(detail::VectorBucket<I, T>& bucket) noexcept
+{
+    return bucket.values;
+}
+
+template <detail::size_t I, class T>
+const std::vector<T>& bucket(const detail::VectorBucket<I, T>& bucket) noexcept
+{
+    return bucket.values;
+}
+}  // namespace detail
+
+// Container of the alternatives stored in many Erased of the same variate function, grouped by alternative. Unlike a
+// `std::vector` of `std::variant` every element only occupies the size of its own alternative and each group can be
+// processed in a loop without branching on the index.
+template <class ErasedT>
+requires detail::is_erased_v<ErasedT>
+class VariateVector
+{
+  private:
+    using Types = detail::ErasedTypes<ErasedT>;
+    using Buckets = detail::VectorBuckets<Types, std::make_index_sequence<detail::TypeListLimits<Types>::count>>;
+
+  public:
+    // Moves the alternative stored in `erased` to the end of the array of its alternative.
+    void push_back(ErasedT&& erased)
+    {
+        detail::ErasedDispatch<typename ErasedT::KeyType>::apply(
+            erased.index,
+            [&]<detail::size_t I, class T>()
+            {
+                detail::bucket<I>(buckets).push_back(static_cast<T&&>(detail::erased_value<T, I>(erased)));
+            });
+    }
+
+    // The array of the alternative at index I.
+    template <std::size_t I>
+    [[nodiscard]] auto& alternative() noexcept
+    {
+        return detail::bucket<I>(buckets);
+    }
+
+    template <std::size_t I>
+    [[nodiscard]] const auto& alternative() const noexcept
+    {
+        return detail::bucket<I>(buckets);
+    }
+
+    // Invoke `function` with a `std::span` over the array of every alternative, in the order of their indices.
+    template <class Function>
+    void for_each_alternative(Function&& function)
+    {
+        buckets.for_each(function);
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return buckets.size(); }
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    void clear() noexcept { buckets.clear(); }
+
+  private:
+    Buckets buckets;
+};
+}  // namespace dehe
+
+#endif  // DEHE_VARIATE_VECTOR_HPP
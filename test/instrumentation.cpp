@@ -0,0 +1,110 @@
+// Copyright (c) 2023 Dennis Hezel
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#define DEHE_VARIATE_INSTRUMENT_RETURN_PATHS
+
+#include <test/framework.hpp>
+#include <variate/variate.hpp>
+
+#include <cstdint>
+#include <string_view>
+
+namespace test
+{
+inline auto instrumented(int i)
+{
+    static constexpr dehe::Variate var;
+    if (i == 0)
+    {
+        return var(1);
+    }
+    if (i == 1)
+    {
+        return var(2.5);
+    }
+    return var('a');
+}
+
+inline auto called_during_static_initialization()
+{
+    static constexpr dehe::Variate var;
+    return var(1);
+}
+
+// Return paths taken during static initialization must be counted, even though the counters are themselves variables
+// with static storage duration.
+const int static_initialization_calls = []
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        static_cast<void>(dehe::make_variant(test::called_during_static_initialization()));
+    }
+    return 3;
+}();
+
+inline bool is_static_initialization_path(const dehe::ReturnPath& path)
+{
+    return std::string_view(path.function_name).find("called_during_static_initialization") != std::string_view::npos;
+}
+
+inline void test_count_return_paths()
+{
+    for (int i = 0; i < 5; ++i)
+    {
+        static_cast<void>(dehe::make_variant(test::instrumented(i % 2)));
+    }
+    std::uint64_t counts[3]{};
+    std::uint_least32_t lines[3]{};
+    dehe::for_each_return_path(
+        [&](const dehe::ReturnPath& path)
+        {
+            if (test::is_static_initialization_path(path))
+            {
+                return;
+            }
+            counts[path.index] = path.count;
+            lines[path.index] = path.line;
+            if (path.count != 0)
+            {
+                CHECK(std::string_view(path.file_name).ends_with("instrumentation.cpp"));
+                CHECK(std::string_view(path.function_name).find("instrumented") != std::string_view::npos);
+            }
+        });
+    CHECK_EQ(3, counts[0]);
+    CHECK_EQ(2, counts[1]);
+    CHECK_EQ(0, counts[2]);
+    CHECK(lines[0] != 0);
+    CHECK(lines[0] < lines[1]);
+    CHECK_EQ(0, lines[2]);
+}
+
+inline void test_count_return_paths_during_static_initialization()
+{
+    static_cast<void>(dehe::make_variant(test::called_during_static_initialization()));
+    std::uint64_t count{};
+    std::uint_least32_t line{};
+    dehe::for_each_return_path(
+        [&](const dehe::ReturnPath& path)
+        {
+            if (test::is_static_initialization_path(path))
+            {
+                count = path.count;
+                line = path.line;
+            }
+        });
+    CHECK_EQ(static_cast<std::uint64_t>(test::static_initialization_calls) + 1, count);
+    CHECK(line != 0);
+}
+}  // namespace test
+
+int main()
+{
+    using namespace test;
+
+    run_test<&test_count_return_paths>();
+    run_test<&test_count_return_paths_during_static_initialization>();
+
+    return finalize_test_results() ? 0 : 1;
+}
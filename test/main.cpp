@@ -14,10 +14,42 @@ int main()
     run_test<&test_make_c_style_array_decay>();
     run_test<&test_make_move_only>();
     run_test<&test_duplicate_type>();
+    run_test<&test_repeated_duplicate_type>();
+    run_test<&test_unique_variate>();
     run_test<&test_too_small_size>();
     run_test<&test_too_small_alignment>();
     run_test<&test_dependent_variate>();
     run_test<&test_dependent_variate_shorthand>();
+    run_test<&test_fit>();
+    run_test<&test_fit_compact_index>();
+    run_test<&test_variate_compact_index>();
+    run_test<&test_fit_oversized>();
+    run_test<&test_make_many_alternatives>();
+    run_test<&test_visit>();
+    run_test<&test_visit_multiple>();
+    run_test<&test_emplace>();
+    run_test<&test_fit_emplace>();
+    run_test<&test_erased_destroys_alternative>();
+    run_test<&test_erased_copy_and_noexcept>();
+    run_test<&test_erased_move_only_in_vector>();
+    run_test<&test_fit_trivially_copyable>();
+    run_test<&test_allocate_oversized>();
+    run_test<&test_allocate_fits_inline_into_small_storage>();
+    run_test<&test_constexpr_fit>();
+    run_test<&test_make_invoker>();
+    run_test<&test_variate_vector>();
+    run_test<&test_make_tagged_union>();
+    run_test<&test_tagged_union_owns_alternative>();
+    run_test<&test_likely>();
+    run_test<&test_flatten>();
+    run_test<&test_ref>();
+    run_test<&test_make_expected>();
+    run_test<&test_assign>();
+    run_test<&test_assign_not_move_assignable>();
+    run_test<&test_index_only_erased>();
+#ifdef __cpp_impl_coroutine
+    run_test<&test_co_await>();
+#endif
 
     return finalize_test_results() ? 0 : 1;
 }
\ No newline at end of file
@@ -9,9 +9,15 @@
 #include <test/framework.hpp>
 #include <test/utility.hpp>
 #include <variate/variate.hpp>
+#include <variate/vector.hpp>
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace test
 {
@@ -85,6 +91,57 @@ inline void test_duplicate_type()
     CHECK_EQ(std::string_view{"2"}, std::get<1>(v2));
 }
 
+inline void test_repeated_duplicate_type()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            return var(1);
+        }
+        if (i == 1)
+        {
+            return var(2);
+        }
+        if (i == 2)
+        {
+            return var(1.5);
+        }
+        return var(3);
+    };
+    auto v = dehe::make_variant(func(3));
+    CHECK(std::is_same_v<decltype(v), std::variant<int, int, double, int>>);
+    CHECK_EQ(3, v.index());
+    CHECK_EQ(3, std::get<3>(v));
+}
+
+inline void test_unique_variate()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::UniqueVariate var;
+        if (i == 0)
+        {
+            return var("1");
+        }
+        if (i == 1)
+        {
+            return var(2);
+        }
+        if (i == 2)
+        {
+            return var("3");
+        }
+        return var(4);
+    };
+    auto v = dehe::make_variant(func(2));
+    CHECK(std::is_same_v<decltype(v), std::variant<const char*, int>>);
+    CHECK_EQ(std::string_view{"3"}, std::get<0>(v));
+    auto v2 = dehe::make_variant(func(3));
+    CHECK_EQ(4, std::get<1>(v2));
+}
+
 inline void test_too_small_size()
 {
     static constexpr dehe::Variate<sizeof(std::int32_t)> var;
@@ -152,6 +209,1072 @@ inline void test_dependent_variate_shorthand()
     CHECK(std::is_same_v<decltype(v2), std::variant<double, const char*>>);
     CHECK_EQ(1.0, std::get<0>(v2));
 }
+
+inline void test_fit()
+{
+    auto func = [](int ok)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (ok == 0)
+                {
+                    return var(std::int16_t{1});
+                }
+                if (ok == 1)
+                {
+                    return var(2.0);
+                }
+                return var(std::string("a very very long test test"));
+            });
+    };
+    auto erased = func(1);
+    CHECK_EQ(sizeof(std::string), sizeof(erased.value));
+    auto v = dehe::make_variant(std::move(erased));
+    CHECK(std::is_same_v<decltype(v), std::variant<std::int16_t, double, std::string>>);
+    CHECK_EQ(2.0, std::get<1>(v));
+    auto v2 = dehe::make_variant(func(2));
+    CHECK_EQ(std::string_view("a very very long test test"), std::get<2>(v2));
+}
+
+inline void test_fit_compact_index()
+{
+    auto func = [](bool ok)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (ok)
+                {
+                    return var(std::int32_t{1});
+                }
+                return var(1.5f);
+            });
+    };
+    auto erased = func(false);
+    CHECK(std::is_same_v<unsigned char, decltype(erased.index)>);
+    CHECK_EQ(2 * sizeof(std::int32_t), sizeof(erased));
+    CHECK_EQ(1.5f, std::get<1>(dehe::make_variant(std::move(erased))));
+}
+
+inline void test_variate_compact_index()
+{
+    auto func = [](bool ok)
+    {
+        static constexpr dehe::Variate<7, 1, std::uint8_t> var;
+        if (ok)
+        {
+            return var('a');
+        }
+        return var(std::array<char, 7>{'b'});
+    };
+    auto erased = func(true);
+    CHECK(std::is_same_v<std::uint8_t, decltype(erased.index)>);
+    CHECK_EQ(8, sizeof(erased));
+    CHECK_EQ('a', std::get<0>(dehe::make_variant(std::move(erased))));
+    CHECK_EQ('b', std::get<1>(dehe::make_variant(func(false)))[0]);
+    auto unique_func = [](bool ok)
+    {
+        static constexpr dehe::UniqueVariate<256, alignof(double), std::uint16_t> var;
+        if (ok)
+        {
+            return var(1);
+        }
+        return var(2);
+    };
+    CHECK(std::is_same_v<std::uint16_t, decltype(unique_func(true).index)>);
+    CHECK_EQ(2, std::get<0>(dehe::make_variant(unique_func(false))));
+    auto dependent_func = []<typename T>(T param)
+    {
+        static constexpr typename dehe::DependentVariate<T>::template Type<16, 8, std::uint8_t> var;
+        return var(param);
+    };
+    CHECK(std::is_same_v<std::uint8_t, decltype(dependent_func(1).index)>);
+    CHECK_EQ(1.5, std::get<0>(dehe::make_variant(dependent_func(1.5))));
+}
+
+inline void test_fit_oversized()
+{
+    struct alignas(32) Large
+    {
+        char data[1000];
+    };
+    auto func = [](bool ok)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (ok)
+                {
+                    return var(Large{{'a'}});
+                }
+                return var(1);
+            });
+    };
+    auto erased = func(true);
+    CHECK_EQ(sizeof(Large), sizeof(erased.value));
+    CHECK_EQ(alignof(Large), alignof(decltype(erased)));
+    auto v = dehe::make_variant(std::move(erased));
+    CHECK_EQ('a', std::get<0>(v).data[0]);
+}
+
+inline void test_make_many_alternatives()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            return var(Alternative<0>{});
+        }
+        if (i == 1)
+        {
+            return var(Alternative<1>{});
+        }
+        if (i == 2)
+        {
+            return var(Alternative<2>{});
+        }
+        if (i == 3)
+        {
+            return var(Alternative<3>{});
+        }
+        if (i == 4)
+        {
+            return var(Alternative<4>{});
+        }
+        if (i == 5)
+        {
+            return var(std::string("a very very long test test"));
+        }
+        return var(Alternative<6>{});
+    };
+    auto v = dehe::make_variant(func(4));
+    CHECK_EQ(7, std::variant_size_v<decltype(v)>);
+    CHECK_EQ(4, v.index());
+    auto v2 = dehe::make_variant(func(5));
+    CHECK_EQ(std::string_view("a very very long test test"), std::get<5>(v2));
+    auto v3 = dehe::make_variant(func(6));
+    CHECK_EQ(6, v3.index());
+    CHECK_EQ(6, std::get<6>(v3).value);
+}
+
+inline void test_visit()
+{
+    auto func = [](bool ok)
+    {
+        static constexpr dehe::Variate var;
+        if (ok)
+        {
+            return var(MoveOnly{42});
+        }
+        return var(std::string("a very very long test test"));
+    };
+    auto size = dehe::visit(
+        []<class T>(T&& value)
+        {
+            CHECK(std::is_rvalue_reference_v<T&&>);
+            if constexpr (std::is_same_v<MoveOnly, std::remove_cvref_t<T>>)
+            {
+                return std::size_t{};
+            }
+            else
+            {
+                return value.size();
+            }
+        },
+        func(false));
+    CHECK_EQ(26, size);
+    auto erased = func(true);
+    dehe::visit(
+        []<class T>(T& value)
+        {
+            if constexpr (std::is_same_v<MoveOnly, T>)
+            {
+                value.v = 24;
+            }
+        },
+        erased);
+    CHECK_EQ(MoveOnly{24}, std::get<0>(dehe::make_variant(std::move(erased))));
+}
+
+inline void test_visit_multiple()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            return var(1);
+        }
+        return var(2.5);
+    };
+    auto first = func(0);
+    const auto second = func(1);
+    auto result = dehe::visit(
+        [](auto&& lhs, auto&& rhs)
+        {
+            return static_cast<double>(lhs) + static_cast<double>(rhs);
+        },
+        first, second);
+    CHECK_EQ(3.5, result);
+}
+
+inline void test_emplace()
+{
+    auto func = [](bool ok)
+    {
+        static constexpr dehe::Variate var;
+        if (ok)
+        {
+            return var.emplace<Immovable>(42);
+        }
+        return var(std::in_place_type<std::string>, std::size_t{3}, 'a');
+    };
+    auto value = dehe::visit(
+        []<class T>(T&& alternative)
+        {
+            if constexpr (std::is_same_v<Immovable, std::remove_cvref_t<T>>)
+            {
+                return alternative.v;
+            }
+            else
+            {
+                return static_cast<int>(alternative.size());
+            }
+        },
+        func(true));
+    CHECK_EQ(42, value);
+    auto make_string = [](int)
+    {
+        static constexpr dehe::Variate var;
+        return var(std::in_place_type<std::string>, std::size_t{3}, 'a');
+    };
+    auto v = dehe::make_variant(make_string(0));
+    CHECK(std::is_same_v<decltype(v), std::variant<std::string>>);
+    CHECK_EQ(std::string_view{"aaa"}, std::get<0>(v));
+}
+
+inline void test_fit_emplace()
+{
+    auto func = [](bool ok)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (ok)
+                {
+                    return var.template emplace<std::string>(std::size_t{3}, 'a');
+                }
+                return var(std::in_place_type<std::int16_t>, 7);
+            });
+    };
+    auto erased = func(false);
+    CHECK_EQ(sizeof(std::string), sizeof(erased.value));
+    CHECK_EQ(std::int16_t{7}, std::get<1>(dehe::make_variant(std::move(erased))));
+    CHECK_EQ(std::string_view{"aaa"}, std::get<0>(dehe::make_variant(func(true))));
+}
+
+inline void test_erased_destroys_alternative()
+{
+    auto func = [](bool ok, int& count)
+    {
+        static constexpr dehe::Variate var;
+        if (ok)
+        {
+            return var(DestructionCounter{count});
+        }
+        return var(1);
+    };
+    int count{};
+    {
+        auto erased = func(true, count);
+        CHECK_EQ(0, count);
+    }
+    CHECK_EQ(1, count);
+    {
+        auto v = dehe::make_variant(func(true, count));
+        CHECK_EQ(1, count);
+    }
+    CHECK_EQ(2, count);
+    {
+        auto erased = func(true, count);
+        auto moved = std::move(erased);
+        CHECK_FALSE(std::is_copy_constructible_v<decltype(moved)>);
+    }
+    CHECK_EQ(3, count);
+    {
+        auto erased = func(true, count);
+        erased = func(false, count);
+        CHECK_EQ(4, count);
+        CHECK_EQ(1, std::get<1>(dehe::make_variant(std::move(erased))));
+        auto erased2 = func(false, count);
+        erased2 = func(true, count);
+        CHECK_EQ(4, count);
+    }
+    CHECK_EQ(5, count);
+    CHECK_FALSE(std::is_trivially_copyable_v<decltype(func(false, count))>);
+}
+
+inline void test_erased_copy_and_noexcept()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            return var(1);
+        }
+        return var(std::string("a very very long test test"));
+    };
+    // Whether all alternatives are copyable is not known when the Erased is instantiated
+    CHECK_FALSE(std::is_copy_constructible_v<decltype(func(0))>);
+    auto erased = func(1);
+    erased = func(0);
+    CHECK_EQ(1, std::get<0>(dehe::make_variant(std::move(erased))));
+    // The move constructor might be needed before the second return path has been seen
+    auto throwing = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            auto erased = var(1);
+            return erased;
+        }
+        return var(ThrowingMove{});
+    };
+    CHECK_FALSE(std::is_nothrow_move_constructible_v<decltype(throwing(0))>);
+    CHECK_EQ(1, std::get<0>(dehe::make_variant(throwing(0))));
+    auto fit_func = [](bool ok)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (ok)
+                {
+                    return var(1);
+                }
+                return var(std::string("a very very long test test"));
+            });
+    };
+    CHECK(std::is_nothrow_move_constructible_v<decltype(fit_func(true))>);
+    auto fit_erased = fit_func(false);
+    auto copy = fit_erased;
+    CHECK_EQ(std::string_view("a very very long test test"), std::get<1>(dehe::make_variant(std::move(copy))));
+    copy = fit_erased;
+    copy = fit_func(true);
+    CHECK_EQ(1, std::get<0>(dehe::make_variant(std::move(copy))));
+    CHECK_EQ(std::string_view("a very very long test test"), std::get<1>(dehe::make_variant(std::move(fit_erased))));
+    auto move_only_fit = [](bool ok)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (ok)
+                {
+                    return var(1);
+                }
+                return var(std::make_unique<int>(5));
+            });
+    };
+    CHECK_FALSE(std::is_copy_constructible_v<decltype(move_only_fit(true))>);
+}
+
+inline void test_erased_move_only_in_vector()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            return var(1);
+        }
+        return var(std::make_unique<int>(5));
+    };
+    std::vector<decltype(func(0))> results;
+    for (int i = 0; i < 10; ++i)
+    {
+        results.push_back(func(i % 2));
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        auto variant = dehe::make_variant(std::move(results[static_cast<std::size_t>(i)]));
+        if (i % 2 == 0)
+        {
+            CHECK_EQ(1, std::get<0>(variant));
+        }
+        else
+        {
+            CHECK_EQ(5, *std::get<1>(variant));
+        }
+    }
+}
+
+inline void test_fit_trivially_copyable()
+{
+    auto func = [](bool ok)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (ok)
+                {
+                    return var(1);
+                }
+                return var(1.5);
+            });
+    };
+    CHECK(std::is_trivially_copyable_v<decltype(func(true))>);
+    auto erased = func(false);
+    auto copy = erased;
+    CHECK_EQ(1.5, std::get<1>(dehe::make_variant(std::move(copy))));
+    auto func2 = [](bool ok)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (ok)
+                {
+                    return var(1);
+                }
+                return var(std::string("a very very long test test"));
+            });
+    };
+    CHECK_FALSE(std::is_trivially_copyable_v<decltype(func2(true))>);
+    auto erased2 = func2(false);
+    auto moved = std::move(erased2);
+    CHECK_EQ(std::string_view("a very very long test test"), std::get<1>(dehe::make_variant(std::move(moved))));
+}
+
+inline void test_allocate_oversized()
+{
+    struct Large
+    {
+        std::string value;
+        char padding[64];
+    };
+    auto func = [](std::pmr::memory_resource* resource, bool ok)
+    {
+        static constexpr dehe::Variate<sizeof(void*) * 2> var;
+        if (ok)
+        {
+            return var(std::allocator_arg, resource, 42);
+        }
+        return var(std::allocator_arg, resource, Large{std::string("a very very long test test"), {}});
+    };
+    test::CountingResource resource;
+    auto v = dehe::make_variant(func(&resource, true));
+    CHECK(std::is_same_v<decltype(v), std::variant<int, Large>>);
+    CHECK_EQ(42, std::get<0>(v));
+    CHECK_EQ(0, resource.allocations);
+    {
+        auto v2 = dehe::make_variant(func(&resource, false));
+        CHECK_EQ(std::string_view("a very very long test test"), std::get<1>(v2).value);
+        CHECK_EQ(1, resource.allocations);
+        CHECK_EQ(1, resource.deallocations);
+    }
+    {
+        auto erased = func(&resource, false);
+        auto moved = std::move(erased);
+        CHECK_EQ(2, resource.allocations);
+        CHECK_EQ(1, resource.deallocations);
+    }
+    CHECK_EQ(2, resource.deallocations);
+}
+
+inline void test_allocate_fits_inline_into_small_storage()
+{
+    // The storage is too small for an Allocated alternative but large enough for an int
+    auto func = [](std::pmr::memory_resource* resource)
+    {
+        static constexpr dehe::Variate<sizeof(int), alignof(int)> var;
+        return var(std::allocator_arg, resource, 42);
+    };
+    test::CountingResource resource;
+    CHECK_EQ(42, std::get<0>(dehe::make_variant(func(&resource))));
+    CHECK_EQ(0, resource.allocations);
+}
+
+constexpr auto decode_opcode(int opcode)
+{
+    return dehe::fit(
+        [&](auto var)
+        {
+            if (opcode == 0)
+            {
+                return var(Alternative<0>{});
+            }
+            if (opcode == 1)
+            {
+                return var(Alternative<1>{});
+            }
+            if (opcode == 2)
+            {
+                return var(std::int16_t{2});
+            }
+            return var(Alternative<0>{3});
+        });
+}
+
+inline void test_constexpr_fit()
+{
+    static constexpr auto table = []
+    {
+        std::array<int, 4> result{};
+        for (int i = 0; i < 4; ++i)
+        {
+            result[i] = dehe::visit(
+                []<class T>(T alternative)
+                {
+                    if constexpr (std::is_same_v<std::int16_t, T>)
+                    {
+                        return int{alternative};
+                    }
+                    else
+                    {
+                        return alternative.value;
+                    }
+                },
+                test::decode_opcode(i));
+        }
+        return result;
+    }();
+    CHECK_EQ(0, table[0]);
+    CHECK_EQ(1, table[1]);
+    CHECK_EQ(2, table[2]);
+    CHECK_EQ(3, table[3]);
+    static constexpr auto variant = dehe::make_variant(test::decode_opcode(3));
+    CHECK_EQ(3, variant.index());
+    CHECK_EQ(3, std::get<3>(variant).value);
+}
+
+inline void test_make_invoker()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            return var(
+                [](int value)
+                {
+                    return value + 1;
+                });
+        }
+        if (i == 1)
+        {
+            return var(
+                [factor = 2](int value)
+                {
+                    return value * factor;
+                });
+        }
+        return var(
+            [text = std::string("a very very long test test")](int value) mutable
+            {
+                text.resize(static_cast<std::size_t>(value));
+                return static_cast<int>(text.size());
+            });
+    };
+    auto invoker = dehe::make_invoker<int(int)>(func(1));
+    CHECK_EQ(4, invoker(2));
+    CHECK_EQ(10, invoker(5));
+    auto moved = std::move(invoker);
+    CHECK_EQ(6, moved(3));
+    auto invoker2 = dehe::make_invoker<long(int)>(func(2));
+    CHECK_EQ(5, invoker2(5));
+    CHECK_EQ(3, invoker2(3));
+    auto invoker3 = dehe::make_invoker<void(int)>(func(0));
+    invoker3(1);
+}
+
+inline auto variate_vector_element(int i)
+{
+    static constexpr dehe::Variate var;
+    if (i % 3 == 0)
+    {
+        return var(i);
+    }
+    if (i % 3 == 1)
+    {
+        return var(static_cast<double>(i));
+    }
+    return var(std::to_string(i));
+}
+
+inline void test_variate_vector()
+{
+    dehe::VariateVector<decltype(test::variate_vector_element(0))> vector;
+    CHECK(vector.empty());
+    for (int i = 0; i < 10; ++i)
+    {
+        vector.push_back(test::variate_vector_element(i));
+    }
+    CHECK_EQ(10, vector.size());
+    CHECK_EQ(4, vector.alternative<0>().size());
+    CHECK_EQ(3, vector.alternative<1>().size());
+    CHECK_EQ(3, vector.alternative<2>().size());
+    CHECK_EQ(std::string_view("5"), vector.alternative<2>()[1]);
+    double sum{};
+    std::size_t strings{};
+    vector.for_each_alternative(
+        [&]<class T>(std::span<T> values)
+        {
+            for (auto& value : values)
+            {
+                if constexpr (std::is_same_v<std::string, T>)
+                {
+                    ++strings;
+                }
+                else
+                {
+                    sum += value;
+                }
+            }
+        });
+    CHECK_EQ(30.0, sum);
+    CHECK_EQ(3, strings);
+    vector.clear();
+    CHECK(vector.empty());
+}
+
+inline void test_make_tagged_union()
+{
+    auto func = [](bool ok)
+    {
+        static constexpr dehe::Variate var;
+        if (ok)
+        {
+            return var(std::int16_t{42});
+        }
+        return var('a');
+    };
+    auto v = dehe::make_tagged_union(func(true));
+    CHECK(std::is_same_v<decltype(v), dehe::TaggedUnion<std::int16_t, char>>);
+    CHECK(std::is_trivially_copyable_v<decltype(v)>);
+    CHECK_EQ(sizeof(std::int16_t) * 2, sizeof(v));
+    CHECK_EQ(0, v.index());
+    CHECK_EQ(42, v.get<0>());
+    v = dehe::make_tagged_union(func(false));
+    auto value = dehe::visit(
+        [](auto alternative)
+        {
+            return static_cast<int>(alternative);
+        },
+        v);
+    CHECK_EQ('a', value);
+}
+
+inline void test_tagged_union_owns_alternative()
+{
+    int count{};
+    {
+        using Union = dehe::TaggedUnion<std::string, DestructionCounter>;
+        CHECK(!std::is_trivially_copyable_v<Union>);
+        CHECK(!std::is_copy_constructible_v<Union>);
+        Union v{std::in_place_index<1>, count};
+        auto moved = std::move(v);
+        Union other{std::in_place_index<0>, "a very very long test test"};
+        other = std::move(moved);
+        CHECK_EQ(0, count);
+        CHECK_EQ(1, other.index());
+    }
+    CHECK_EQ(1, count);
+    dehe::TaggedUnion<int, std::string> v{std::in_place_index<1>, "a very very long test test"};
+    auto copy = v;
+    CHECK_EQ(std::string_view("a very very long test test"), copy.get<1>());
+    dehe::visit(
+        []<class T>(T&& alternative)
+        {
+            CHECK(std::is_rvalue_reference_v<T&&>);
+            [[maybe_unused]] std::remove_cvref_t<T> stolen{std::move(alternative)};
+        },
+        std::move(copy));
+    CHECK(copy.get<1>().empty());
+    v = copy;
+    CHECK(v.get<1>().empty());
+}
+
+inline void test_likely()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            return var(Alternative<0>{});
+        }
+        if (i == 1)
+        {
+            return var(Alternative<1>{});
+        }
+        if (i == 2)
+        {
+            return var(Alternative<2>{});
+        }
+        if (i == 3)
+        {
+            return var(Alternative<3>{});
+        }
+        if (i == 4)
+        {
+            return var(std::string("a very very long test test"));
+        }
+        return var.likely(Alternative<5>{});
+    };
+    for (int i = 0; i < 6; ++i)
+    {
+        auto v = dehe::make_variant(func(i));
+        CHECK_EQ(6, std::variant_size_v<decltype(v)>);
+        CHECK_EQ(static_cast<std::size_t>(i), v.index());
+    }
+    auto v = dehe::make_variant(func(4));
+    CHECK_EQ(std::string_view("a very very long test test"), std::get<4>(v));
+    CHECK_EQ(5, dehe::visit(
+                    []<class T>(T&& alternative)
+                    {
+                        if constexpr (std::is_same_v<Alternative<5>, std::remove_cvref_t<T>>)
+                        {
+                            return alternative.value;
+                        }
+                        else
+                        {
+                            return -1;
+                        }
+                    },
+                    func(5)));
+    auto fit_func = [](int i)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (i == 0)
+                {
+                    return var(Alternative<0>{});
+                }
+                if (i == 1)
+                {
+                    return var.likely(1);
+                }
+                return var.likely(2.5);
+            });
+    };
+    CHECK_EQ(1, std::get<1>(dehe::make_variant(fit_func(1))));
+    CHECK_EQ(2.5, std::get<2>(dehe::make_variant(fit_func(2))));
+    CHECK_EQ(0, dehe::make_variant(fit_func(0)).index());
+}
+
+inline auto flatten_inner(int i)
+{
+    static constexpr dehe::Variate var;
+    if (i == 0)
+    {
+        return var(1);
+    }
+    return var(std::string("a very very long test test"));
+}
+
+inline auto flatten_middle(int i)
+{
+    static constexpr dehe::Variate var;
+    if (i < 2)
+    {
+        return var.flatten(test::flatten_inner(i));
+    }
+    return var(2.5);
+}
+
+inline void test_flatten()
+{
+    auto func = [](int i)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (i == 3)
+                {
+                    return var(Alternative<3>{});
+                }
+                return var.flatten(test::flatten_middle(i));
+            });
+    };
+    using Variant = decltype(dehe::make_variant(func(0)));
+    CHECK((std::is_same_v<std::variant<Alternative<3>, int, std::string, double>, Variant>));
+    CHECK_EQ(sizeof(std::string), sizeof(func(0).value));
+    CHECK_EQ(1, std::get<1>(dehe::make_variant(func(0))));
+    CHECK_EQ(std::string_view("a very very long test test"), std::get<2>(dehe::make_variant(func(1))));
+    CHECK_EQ(2.5, std::get<3>(dehe::make_variant(func(2))));
+    CHECK_EQ(3, std::get<0>(dehe::make_variant(func(3))).value);
+    int count{};
+    {
+        auto nested = [&]
+        {
+            static constexpr dehe::Variate var;
+            return var.flatten(dehe::fit(
+                [&](auto inner_var)
+                {
+                    return inner_var(DestructionCounter{count});
+                }));
+        }();
+        CHECK_EQ(0, count);
+    }
+    CHECK_EQ(1, count);
+}
+
+inline void test_ref()
+{
+    static std::string cached{"a very very long test test"};
+    static const std::string const_cached{"a const test"};
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate<sizeof(std::string), alignof(std::string)> var;
+        if (i == 0)
+        {
+            return var.ref(cached);
+        }
+        if (i == 1)
+        {
+            return var.ref(const_cached);
+        }
+        return var(std::string("fresh"));
+    };
+    using Variant = decltype(dehe::make_variant(func(0)));
+    CHECK((std::is_same_v<std::variant<std::reference_wrapper<std::string>, std::reference_wrapper<const std::string>,
+                                       std::string>,
+                          Variant>));
+    auto v = dehe::make_variant(func(0));
+    CHECK_EQ(&cached, &std::get<0>(v).get());
+    std::get<0>(v).get() += "!";
+    CHECK_EQ(std::string_view("a very very long test test!"), cached);
+    CHECK_EQ(&const_cached, &std::get<1>(dehe::make_variant(func(1))).get());
+    CHECK_EQ(std::string_view("fresh"), std::get<2>(dehe::make_variant(func(2))));
+    // Temporaries would be destroyed before the reference is used
+    static constexpr dehe::Variate<sizeof(std::string), alignof(std::string)> ref_var;
+    auto accepts_ref = []<class T>(T&& object)
+    {
+        return requires { ref_var.ref(static_cast<T&&>(object)); };
+    };
+    CHECK(accepts_ref(const_cached));
+    CHECK_FALSE(accepts_ref(static_cast<const std::string&&>(const_cached)));
+    auto fit_func = [](bool ok)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (ok)
+                {
+                    return var.ref(cached);
+                }
+                return var(1);
+            });
+    };
+    CHECK_EQ(sizeof(std::string*), sizeof(fit_func(true).value));
+    CHECK_EQ(&cached, &std::get<0>(dehe::make_variant(fit_func(true))).get());
+}
+
+inline void test_make_expected()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            return var(Alternative<0>{});
+        }
+        if (i == 1)
+        {
+            return var(std::string("a very very long test test"));
+        }
+        if (i == 2)
+        {
+            return var.expected(2.5);
+        }
+        return var(Alternative<3>{});
+    };
+    using Expected = decltype(dehe::make_expected(func(0)));
+    CHECK((std::is_same_v<dehe::Expected<double, std::variant<Alternative<0>, std::string, Alternative<3>>>, Expected>));
+    auto value = dehe::make_expected(func(2));
+    CHECK(value.has_value());
+    CHECK_EQ(2.5, *value);
+    CHECK_EQ(2.5, value.value());
+    auto error = dehe::make_expected(func(1));
+    CHECK_FALSE(error);
+    CHECK_EQ(1, error.error().index());
+    CHECK_EQ(std::string_view("a very very long test test"), std::get<1>(error.error()));
+    CHECK_EQ(2, dehe::make_expected(func(3)).error().index());
+    CHECK_EQ(0, std::get<0>(dehe::make_expected(func(0)).error()).value);
+    auto fit_func = [](bool ok)
+    {
+        return dehe::fit(
+            [&](auto var)
+            {
+                if (ok)
+                {
+                    return var.expected(Alternative<1>{});
+                }
+                return var(Alternative<2>{});
+            });
+    };
+    CHECK_EQ(1, dehe::make_expected(fit_func(true))->value);
+    CHECK_EQ(2, std::get<0>(dehe::make_expected(fit_func(false)).error()).value);
+}
+
+inline void test_assign()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            return var(MoveCounter{});
+        }
+        if (i == 1)
+        {
+            return var(std::string("a very very long test test"));
+        }
+        return var(i);
+    };
+    std::variant<MoveCounter, std::string, int> variant;
+    dehe::assign(variant, func(0));
+    CHECK_EQ(0, variant.index());
+    CHECK_EQ(1, std::get<0>(variant).assignments);
+    dehe::assign(variant, func(0));
+    CHECK_EQ(2, std::get<0>(variant).assignments);
+    CHECK_EQ(0, std::get<0>(variant).constructions);
+    dehe::assign(variant, func(1));
+    CHECK_EQ(std::string_view("a very very long test test"), std::get<1>(variant));
+    dehe::assign(variant, func(5));
+    CHECK_EQ(5, std::get<2>(variant));
+    dehe::assign(variant, func(0));
+    CHECK_EQ(1, std::get<0>(variant).constructions);
+    CHECK_EQ(0, std::get<0>(variant).assignments);
+}
+
+inline void test_assign_not_move_assignable()
+{
+    auto func = [](int i)
+    {
+        static constexpr dehe::Variate var;
+        if (i == 0)
+        {
+            return var(1);
+        }
+        return var(
+            [i]
+            {
+                return i;
+            });
+    };
+    using Variant = decltype(dehe::make_variant(func(0)));
+    CHECK_FALSE(std::is_move_assignable_v<std::variant_alternative_t<1, Variant>>);
+    Variant variant;
+    dehe::assign(variant, func(2));
+    CHECK_EQ(2, std::get<1>(variant)());
+    dehe::assign(variant, func(3));
+    CHECK_EQ(3, std::get<1>(variant)());
+    dehe::assign(variant, func(0));
+    CHECK_EQ(1, std::get<0>(variant));
+}
+
+struct Idle
+{
+};
+
+struct Running
+{
+};
+
+constexpr auto next_state(int event)
+{
+    return dehe::fit(
+        [&](auto var)
+        {
+            if (event == 0)
+            {
+                return var(Idle{});
+            }
+            if (event == 1)
+            {
+                return var(Running{});
+            }
+            return var(
+                []
+                {
+                    return 42;
+                });
+        });
+}
+
+inline void test_index_only_erased()
+{
+    CHECK_EQ(1, sizeof(test::next_state(0)));
+    CHECK(std::is_trivially_copyable_v<decltype(test::next_state(0))>);
+    static constexpr auto index = dehe::make_variant(test::next_state(1)).index();
+    CHECK_EQ(1, index);
+    CHECK_EQ(0, dehe::make_variant(test::next_state(0)).index());
+    CHECK_EQ(42, std::get<2>(dehe::make_variant(test::next_state(2)))());
+    CHECK_EQ(2, dehe::visit(
+                    []<class T>(T&&)
+                    {
+                        return std::is_invocable_v<T> ? 2 : 0;
+                    },
+                    test::next_state(2)));
+    auto non_empty = dehe::fit(
+        [&](auto var)
+        {
+            if (index == 0)
+            {
+                return var(Idle{});
+            }
+            return var(Alternative<1>{});
+        });
+    CHECK_EQ(1, std::get<1>(dehe::make_variant(std::move(non_empty))).value);
+}
+
+#ifdef __cpp_impl_coroutine
+inline auto awaitable_variate(int i, std::coroutine_handle<>* handle)
+{
+    static constexpr dehe::Variate var;
+    if (i == 0)
+    {
+        return var(ReadyAwaiter{1});
+    }
+    if (i == 1)
+    {
+        return var(SuspendingAwaiter{handle, 2});
+    }
+    return var(Awaitable{3});
+}
+
+// GCC considers the lambda type that makes every Variate unique to be TU-local and warns about the coroutine frame
+// containing it.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsubobject-linkage"
+#endif
+
+inline Detached await_all(std::coroutine_handle<>& handle, int& sum)
+{
+    sum += co_await test::awaitable_variate(0, &handle);
+    sum += co_await test::awaitable_variate(1, &handle);
+    sum += co_await test::awaitable_variate(2, &handle);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+inline void test_co_await()
+{
+    std::coroutine_handle<> handle;
+    int sum{};
+    test::await_all(handle, sum);
+    CHECK_EQ(1, sum);
+    CHECK(bool{handle});
+    handle.resume();
+    CHECK_EQ(6, sum);
+}
+#endif
 }  // namespace test
 
 #endif  // DEHE_TEST_TEST_HPP
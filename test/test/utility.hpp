@@ -6,6 +6,14 @@
 #ifndef DEHE_TEST_UTILITY_HPP
 #define DEHE_TEST_UTILITY_HPP
 
+#include <cstddef>
+#include <exception>
+#include <memory_resource>
+
+#ifdef __cpp_impl_coroutine
+#include <coroutine>
+#endif
+
 namespace test
 {
 struct MoveOnly
@@ -26,6 +34,164 @@ struct MoveOnly
 
     friend bool operator==(const MoveOnly&, const MoveOnly&) = default;
 };
+
+struct ThrowingMove
+{
+    ThrowingMove() = default;
+
+    ThrowingMove(ThrowingMove&&) noexcept(false) {}
+};
+
+// Records whether it was move constructed and how often it has been move assigned to since.
+struct MoveCounter
+{
+    int constructions{};
+    int assignments{};
+
+    MoveCounter() = default;
+
+    MoveCounter(MoveCounter&&) noexcept : constructions(1) {}
+
+    MoveCounter& operator=(MoveCounter&&) noexcept
+    {
+        ++assignments;
+        return *this;
+    }
+};
+
+// Counts how often an object that has not been moved from is destroyed.
+struct DestructionCounter
+{
+    int* count{};
+
+    constexpr explicit DestructionCounter(int& count) noexcept : count(&count) {}
+
+    DestructionCounter(const DestructionCounter&) = delete;
+
+    constexpr DestructionCounter(DestructionCounter&& other) noexcept : count(other.count) { other.count = nullptr; }
+
+    DestructionCounter& operator=(const DestructionCounter&) = delete;
+
+    DestructionCounter& operator=(DestructionCounter&&) = delete;
+
+    ~DestructionCounter()
+    {
+        if (count != nullptr)
+        {
+            ++*count;
+        }
+    }
+};
+
+struct Immovable
+{
+    int v{};
+
+    constexpr explicit Immovable(int v) noexcept : v(v) {}
+
+    Immovable(const Immovable&) = delete;
+
+    Immovable(Immovable&&) = delete;
+
+    Immovable& operator=(const Immovable&) = delete;
+
+    Immovable& operator=(Immovable&&) = delete;
+};
+
+// Memory resource that counts allocations and deallocations and forwards them to the default resource.
+struct CountingResource : std::pmr::memory_resource
+{
+    int allocations{};
+    int deallocations{};
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocations;
+        return std::pmr::get_default_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override
+    {
+        ++deallocations;
+        std::pmr::get_default_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+template <int Value>
+struct Alternative
+{
+    int value{Value};
+};
+
+#ifdef __cpp_impl_coroutine
+// Eagerly started coroutine that destroys itself upon completion.
+struct Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() noexcept { return {}; }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+struct ReadyAwaiter
+{
+    int value{};
+
+    bool await_ready() const noexcept { return true; }
+
+    void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+    int await_resume() const noexcept { return value; }
+};
+
+// Suspends and hands out the coroutine handle so that it can be resumed later.
+struct SuspendingAwaiter
+{
+    std::coroutine_handle<>* handle{};
+    int value{};
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> coroutine) const noexcept { *handle = coroutine; }
+
+    int await_resume() const noexcept { return value; }
+};
+
+// Awaitable whose immovable awaiter decides not to suspend after all.
+struct Awaitable
+{
+    int value{};
+
+    struct Awaiter
+    {
+        int value{};
+
+        constexpr explicit Awaiter(int value) noexcept : value(value) {}
+
+        Awaiter(const Awaiter&) = delete;
+
+        Awaiter& operator=(const Awaiter&) = delete;
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<>) const noexcept { return false; }
+
+        int await_resume() const noexcept { return value; }
+    };
+
+    Awaiter operator co_await() && noexcept { return Awaiter{value}; }
+};
+#endif
 }  // namespace test
 
 #endif  // DEHE_TEST_UTILITY_HPP
@@ -0,0 +1,132 @@
+// Copyright (c) 2023 Dennis Hezel
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include <test/framework.hpp>
+#include <unifex/just.hpp>
+#include <unifex/let_value.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/type_list.hpp>
+#include <variate/unifex.hpp>
+#include <variate/variate.hpp>
+
+#include <exception>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace test
+{
+// Sender of `value` that counts how often it is moved.
+struct MoveCountingSender
+{
+    template <template <class...> class Variant, template <class...> class Tuple>
+    using value_types = Variant<Tuple<int>>;
+
+    template <template <class...> class Variant>
+    using error_types = Variant<>;
+
+    static constexpr bool sends_done = false;
+
+    template <class Receiver>
+    struct Operation
+    {
+        Receiver receiver;
+        int value;
+
+        friend void tag_invoke(unifex::tag_t<unifex::start>, Operation& operation) noexcept
+        {
+            unifex::set_value(static_cast<Receiver&&>(operation.receiver), operation.value);
+        }
+    };
+
+    int* moves;
+    int value;
+
+    MoveCountingSender(int* move_counter, int sender_value) : moves(move_counter), value(sender_value) {}
+
+    MoveCountingSender(MoveCountingSender&& other) noexcept : moves(other.moves), value(other.value) { ++*moves; }
+
+    template <class Receiver>
+    friend Operation<std::remove_cvref_t<Receiver>> tag_invoke(unifex::tag_t<unifex::connect>,
+                                                               MoveCountingSender&& sender, Receiver&& receiver)
+    {
+        return {static_cast<Receiver&&>(receiver), sender.value};
+    }
+};
+
+inline auto code(bool ok)
+{
+    static constexpr dehe::Variate var;
+    if (ok)
+    {
+        return var(unifex::just(5));
+    }
+    return var(unifex::just() | unifex::then(
+                                    []
+                                    {
+                                        return 42;
+                                    }));
+}
+
+inline auto counting(int* moves, bool ok)
+{
+    static constexpr dehe::Variate var;
+    if (ok)
+    {
+        return var(std::in_place_type<MoveCountingSender>, moves, 1);
+    }
+    return var(unifex::just(2));
+}
+
+inline void test_variant_sender_completion_signatures()
+{
+    using Sender = decltype(dehe::VariantSender{test::code(true)});
+    CHECK((std::is_same_v<unifex::type_list<unifex::type_list<int>>,
+                          unifex::sender_value_types_t<Sender, unifex::type_list, unifex::type_list>>));
+    CHECK((std::is_same_v<unifex::type_list<std::exception_ptr>,
+                          unifex::sender_error_types_t<Sender, unifex::type_list>>));
+    CHECK_FALSE(unifex::sender_traits<Sender>::sends_done);
+}
+
+inline void test_variant_sender_sync_wait()
+{
+    for (const bool ok : {true, false})
+    {
+        auto sender = unifex::let_value(unifex::just(ok),
+                                        [](bool selected)
+                                        {
+                                            return dehe::VariantSender{test::code(selected)};
+                                        });
+        const auto result = unifex::sync_wait(std::move(sender));
+        CHECK(result.has_value());
+        CHECK_EQ(ok ? 5 : 42, *result);
+    }
+    CHECK_EQ(42, *unifex::sync_wait(dehe::make_variant_sender(test::code(false))));
+}
+
+inline void test_variant_sender_connects_in_place()
+{
+    int moves{};
+    CHECK_EQ(1, *unifex::sync_wait(dehe::VariantSender{test::counting(&moves, true)}));
+    CHECK_EQ(0, moves);
+    CHECK_EQ(1, *unifex::sync_wait(dehe::make_variant_sender(test::counting(&moves, true))));
+    CHECK_EQ(1, moves);
+    CHECK_EQ(2, *unifex::sync_wait(dehe::VariantSender{test::counting(&moves, false)}));
+}
+}  // namespace test
+
+int main()
+{
+    using namespace test;
+
+    run_test<&test_variant_sender_completion_signatures>();
+    run_test<&test_variant_sender_sync_wait>();
+    run_test<&test_variant_sender_connects_in_place>();
+
+    return finalize_test_results() ? 0 : 1;
+}